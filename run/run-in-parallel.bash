@@ -17,8 +17,11 @@ if [[ $# != 1 ]] ; then
 	exit 1
 fi
 
+# run every ID in one transfil_N process instead of one process per ID
+BATCH_MODE=${BATCH_MODE:=false}
+
 # make sure 'parallel' program is installed
-if [[ -z "$( which parallel )" ]] ; then
+if [[ "${BATCH_MODE}" != "true" ]] && [[ -z "$( which parallel )" ]] ; then
 	echo "=> error: please ensure you've installed GNU 'parallel' before running this script." >&2
 	exit 1
 fi
@@ -51,11 +54,49 @@ echo "-> running LF model at ${RUN_STAMP} using ${NUM_PARALLEL_JOBS} parallel jo
 # shellcheck disable=SC2086
 echo "-> saving output into ${output_folder_name}" >&2
 
-# run the job in parallel
-NUM_SIMULATIONS=${NUM_SIMULATIONS:=5} \
-STARTING_YEAR=${STARTING_YEAR:=2020} \
-	parallel "${JOBS_ARG}" -a "${RUNNING_ID_LIST_FILE}" \
-	pipenv run bash run-lf-model.bash "${output_folder_name}"
+if [[ "${BATCH_MODE}" = "true" ]] ; then
+
+	# same defaults and options as run-lf-model.bash
+	PARAMETER_ROOT="${PARAMETER_ROOT:=./parameters}"
+	SCENARIO_ROOT="${SCENARIO_ROOT:=./scenarios}"
+	[[ "${NUM_PARALLEL_JOBS}" = "default" ]] && BATCH_JOBS=$( nproc ) || BATCH_JOBS="${NUM_PARALLEL_JOBS}"
+	[[ "${USE_SEED_FILE:-}" = "true" ]] && SEED_ARGS="-g ${SEED_ROOT}/${SEED_FILE_STEM}" || SEED_ARGS=""
+	[[ "${OUTPUT_ENDGAME:-}" = "true" ]] && OUTPUT_ENDGAME_ARG=1 || OUTPUT_ENDGAME_ARG=0
+	[[ "${OUTPUT_NTDMC:-}" = "true" ]] && OUTPUT_NTDMC_ARG=1 || OUTPUT_NTDMC_ARG=0
+	[[ "${REDUCE_IMP_VIA_XML:-}" = "true" ]] && REDUCE_IMP_VIA_XML_ARG=1 || REDUCE_IMP_VIA_XML_ARG=0
+
+	# shellcheck disable=SC2086
+	time ./transfil_N batch \
+		--ids "${RUNNING_ID_LIST_FILE}" \
+		-s "${SCENARIO_ROOT}/${SCENARIO_FILE_STEM}" \
+		-n "${POP_DISTRIBUTION_FILE}" \
+		-p "${PARAMETER_ROOT}/${PARAMETER_FILE_STEM}" \
+		-r "${NUM_SIMULATIONS:=5}" \
+		-t "${TIMESTEP}" \
+		-o "${RESULTS_ROOT}" \
+		-e "${OUTPUT_ENDGAME_ARG}" \
+		-x "${REDUCE_IMP_VIA_XML_ARG}" \
+		-D "${STARTING_YEAR:=2020}" \
+		-m "${OUTPUT_NTDMC_ARG}" \
+		-N "${OUTPUT_NTDMC_DATE}" \
+		-w "${output_folder_name}" \
+		-j "${BATCH_JOBS}" \
+		${SEED_ARGS}
+
+	echo "== bzip2-ing output files in ${output_folder_name}/lf"
+	find "${output_folder_name}/lf" -name "*.csv" -exec bzip2 --force --best {} +
+
+	if [[ "${KEEP_INTERMEDIATE_RESULTS:-}" = "false" ]] ; then
+		rm -rf "${RESULTS_ROOT}"/*/IHME_scen* "${RESULTS_ROOT}"/*/NTDMC_scen*
+	fi
+else
+
+	# run the job in parallel
+	NUM_SIMULATIONS=${NUM_SIMULATIONS:=5} \
+	STARTING_YEAR=${STARTING_YEAR:=2020} \
+		parallel "${JOBS_ARG}" -a "${RUNNING_ID_LIST_FILE}" \
+		pipenv run bash run-lf-model.bash "${output_folder_name}"
+fi
 
 # clean up intermediate files?
 if [[ "${KEEP_INTERMEDIATE_RESULTS}" = "false" ]] ; then
@@ -34,6 +34,14 @@ function run_ID () {
 	[[ "${OUTPUT_NTDMC}" = "true" ]] && OUTPUT_NTDMC_ARG=1 || OUTPUT_NTDMC_ARG=0
 	[[ "${REDUCE_IMP_VIA_XML}" = "true" ]] && REDUCE_IMP_VIA_XML_ARG=1 || REDUCE_IMP_VIA_XML_ARG=0
 
+	# transfil_N writes the combined draws files itself unless the python
+	# combiner is asked for
+	if [[ "${COMBINE_WITH_PYTHON}" = "true" ]] ; then
+		DRAWS_ARGS=""
+	else
+		DRAWS_ARGS="-w ${output_folder_name}"
+	fi
+
 	echo "== making result directory ${RESULTS} for ID ${id}"
 
 	mkdir -p "${RESULTS}"
@@ -51,6 +59,7 @@ function run_ID () {
 #		-e <output_endgame=1>
 #		-x <reduce_imp_via-xml=0>
 #		-D <outputEndgameDate=2000>
+#		-w <draws_directory>
 
 	time ./transfil_N 0 \
 		-s "${SCENARIO}" \
@@ -64,7 +73,8 @@ function run_ID () {
 		-x "${REDUCE_IMP_VIA_XML_ARG}" \
 		-D "${STARTING_YEAR}" \
 		-m "${OUTPUT_NTDMC_ARG}" \
-		-N "${OUTPUT_NTDMC_DATE}"
+		-N "${OUTPUT_NTDMC_DATE}" \
+		${DRAWS_ARGS}
 
 	echo "== combining output files for IHME & NTDMC using output folder ${output_folder_name}"
 	( time do_file_combinations "${id}" "${output_folder_name}" "${RESULTS}" ) 2>&1
@@ -125,8 +135,10 @@ function combine_output_files () {
 	# create the output dir
 	mkdir -p "${LOCAL_IU_OUTPUT_DIR}"
 
-	# run the combiner
-	python3 combine-lf-outputs.py "${NUM_SIMULATIONS}" "${MODEL_OUTPUT_FILE_ROOT}" "${LOCAL_IU_OUTPUT_FILE_PATH}"
+	# run the combiner, unless transfil_N has already written the file
+	if [[ "${COMBINE_WITH_PYTHON}" = "true" ]] ; then
+		python3 combine-lf-outputs.py "${NUM_SIMULATIONS}" "${MODEL_OUTPUT_FILE_ROOT}" "${LOCAL_IU_OUTPUT_FILE_PATH}"
+	fi
 
 	echo "== bzip2-ing output file ${LOCAL_IU_OUTPUT_FILE_PATH}"
 	bzip2 --force --best "${LOCAL_IU_OUTPUT_FILE_PATH}"
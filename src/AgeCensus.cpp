@@ -0,0 +1,121 @@
+//
+//  AgeCensus.cpp
+//  transfil
+//
+//  Per age-year tallies of the population for the yearly IHME output.
+//
+
+#include "AgeCensus.hpp"
+#include "HostStore.hpp"
+#include "MFPositive.hpp"
+#include "Statistics.hpp"
+#include <algorithm>
+#include <cmath>
+
+int AgeCensus::ageYear(double age) const {
+
+  // whole years of age, such that 12 * year <= age < 12 * (year + 1) holds
+  // exactly, as in the month comparisons this replaces
+  int year = (int)std::floor(age / 12);
+  if (12 * year > age)
+    year--;
+  else if (12 * (year + 1) <= age)
+    year++;
+  return year;
+}
+
+void AgeCensus::count(const HostStore &hosts, int size, int maxAge) {
+
+  number.assign(maxAge, 0);
+  bin.resize(size);
+
+  for (int i = 0; i < size; i++) {
+    bin[i] = ageYear(hosts.age[i]);
+    if (bin[i] >= 0 && bin[i] < maxAge)
+      number[bin[i]]++;
+  }
+}
+
+void AgeCensus::take(HostStore &hosts, int size, int maxAge,
+                     int HydroceleTotalWorms, int LymphodemaTotalWorms,
+                     Statistics &stats, MFPositive &mfPositive,
+                     bool expectedMF) {
+
+  count(hosts, size, maxAge);
+
+  // order the hosts by bin, keeping host order within each bin
+  binStart.assign(maxAge + 1, 0);
+  for (int j = 0; j < maxAge; j++)
+    binStart[j + 1] = binStart[j] + number[j];
+  byAge.resize(binStart[maxAge]);
+  std::vector<int> next(binStart.begin(), binStart.end() - 1);
+  for (int i = 0; i < size; i++)
+    if (bin[i] >= 0 && bin[i] < maxAge)
+      byAge[next[bin[i]]++] = i;
+
+  // sampled, or expected, mf prevalence
+  mfPrev.assign(maxAge, 0.0);
+  for (int j = 0; j < maxAge; j++) {
+    double MFpos = 0;
+    for (int k = binStart[j]; k < binStart[j + 1]; k++)
+      if (expectedMF)
+        MFpos += mfPositive(hosts, byAge[k]);
+      else if (stats.uniform_dist() < mfPositive(hosts, byAge[k]))
+        MFpos++;
+    if (number[j] > 0)
+      mfPrev[j] = MFpos / number[j];
+  }
+
+  // sequelae. Individual susceptibility * total worms > threshold or not.
+  // Only men can get hydrocele
+  std::vector<double> hydroPos(maxAge, 0.0), hydroNum(maxAge, 0.0);
+  std::vector<double> lymphoPos(maxAge, 0.0), lymphoNum(maxAge, 0.0);
+  for (int i = 0; i < size; i++) {
+    int b = bin[i];
+    if (b < 0 || b > maxAge)
+      continue;
+    bool male = hosts.sex[i] == 0;
+    bool hydro =
+        male && ((hosts.hydroMult[i] * hosts.totalWorms[i]) > HydroceleTotalWorms);
+    bool lympho =
+        (hosts.lymphoMult[i] * hosts.totalWorms[i]) > LymphodemaTotalWorms;
+
+    // a host on a whole year is also at the top of the previous bin
+    int lowest = (b > 0 && hosts.age[i] == 12 * b) ? b - 1 : b;
+    for (int j = lowest; j <= b && j < maxAge; j++) {
+      if (male)
+        hydroNum[j]++;
+      if (hydro)
+        hydroPos[j]++;
+      lymphoNum[j]++;
+      if (lympho)
+        lymphoPos[j]++;
+    }
+  }
+  hydrocele.assign(maxAge, 0.0);
+  lymphodema.assign(maxAge, 0.0);
+  for (int j = 0; j < maxAge; j++) {
+    if (hydroNum[j] > 0)
+      hydrocele[j] = hydroPos[j] / hydroNum[j];
+    if (lymphoNum[j] > 0)
+      lymphodema[j] = lymphoPos[j] / lymphoNum[j];
+  }
+
+  // incidence, in host order. Ages over maxAge go in the last bin
+  incidence.assign(maxAge, 0);
+  for (int i = 0; i < size; i++) {
+    float flooredAge = std::floor(hosts.age[i] / 12);
+    int flooredAgeInt = std::min(static_cast<int>(flooredAge), maxAge - 1);
+    bool infectedMF = (stats.uniform_dist() < mfPositive(hosts, i));
+
+    if (infectedMF) {
+
+      if (hosts.previouslyInfected[i] == 0) {
+        incidence[flooredAgeInt] += 1; // if mf positive, increment MFpos by 1
+        hosts.previouslyInfected[i] = 1;
+      }
+    } else {
+      hosts.previouslyInfected[i] = 0;
+    }
+  }
+}
@@ -0,0 +1,55 @@
+//
+//  AgeCensus.hpp
+//  transfil
+//
+//  Per age-year tallies of the population for the yearly IHME output.
+//
+
+#ifndef AgeCensus_hpp
+#define AgeCensus_hpp
+
+#include <vector>
+
+class HostStore;
+class MFPositive;
+class Statistics;
+
+// Bins for each year of age 0 to maxAge-1, all filled by one walk over the
+// hosts instead of a scan of the population per bin and per measure.
+//
+// Bin j holds hosts aged [j, j+1) years, except for the sequelae which, as
+// before, count hosts aged [j, j+1] years so a host exactly j+1 years old is
+// counted in both bins j and j+1. The sampled mf test takes its random draws
+// bin by bin, in host order within a bin, so the random stream is used in the
+// same order as when each bin was scanned separately.
+
+class AgeCensus {
+
+public:
+  // count the hosts in each bin. This is all a survey needs
+  void count(const HostStore &hosts, int size, int maxAge);
+  // count and fill every bin, then update incidence. Uses stats for the
+  // sampled mf test and the incidence test, with the hosts' probabilities of
+  // testing mf positive from mfPositive, and sets each host's
+  // previouslyInfected. With expectedMF the mf prevalence is the mean of
+  // those probabilities instead of a sample, and takes no draws
+  void take(HostStore &hosts, int size, int maxAge, int HydroceleTotalWorms,
+            int LymphodemaTotalWorms, Statistics &stats,
+            MFPositive &mfPositive, bool expectedMF = false);
+
+  std::vector<int> number;        // hosts in bin
+  std::vector<double> mfPrev;     // sampled or expected mf prevalence
+  std::vector<double> hydrocele;  // proportion of men with hydrocele
+  std::vector<double> lymphodema; // proportion with lymphodema
+  std::vector<int> incidence;     // new mf positives since last year
+
+private:
+  int ageYear(double age) const;
+
+  // host indices ordered by bin, and where each bin starts
+  std::vector<int> byAge;
+  std::vector<int> binStart;
+  std::vector<int> bin;
+};
+
+#endif /* AgeCensus_hpp */
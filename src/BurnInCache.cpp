@@ -0,0 +1,127 @@
+//
+//  BurnInCache.cpp
+//  transfil
+//
+//  On-disk store of the state reached at the end of a burn-in.
+//
+
+#include "BurnInCache.hpp"
+#include "Population.hpp"
+#include "Vector.hpp"
+#include "Worm.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+namespace fs = std::filesystem;
+
+static const std::string magic = "transfil burn-in\n";
+
+BurnInCache::BurnInCache(std::string folder, std::string paramList)
+    : folder(folder), paramList(paramList) {
+
+  fs::create_directories(folder);
+}
+
+std::string BurnInCache::key(unsigned long int seed, const Population &popln,
+                             const Vector &vectors, const Worm &worms,
+                             double dt, std::string rule) const {
+
+  // doubles in hex so that the key is exact
+  std::ostringstream key;
+  key << std::hexfloat;
+  key << "version " << version << "\n";
+  key << "generator " << popln.getStats().getGeneratorName() << "\n";
+  key << "seed " << seed << "\n";
+  key << "dt " << dt << "\n";
+  key << "burn-in " << rule << "\n";
+  key << "random values";
+  for (double v : popln.printRandomVariableValues())
+    key << " " << v;
+  for (double v : vectors.printRandomVariableValues())
+    key << " " << v;
+  for (double v : worms.printRandomVariableValues())
+    key << " " << v;
+  key << "\n" << paramList;
+  return key.str();
+}
+
+std::string BurnInCache::fileName(const std::string &key) const {
+
+  // 64 bit FNV-1a, which unlike std::hash is the same on every platform
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream fname;
+  fname << folder << "/burnin-" << std::hex << hash << ".bin";
+  return fname.str();
+}
+
+bool BurnInCache::restore(const std::string &key, Population &popln,
+                          Vector &vectors, int &steps) const {
+
+  std::ifstream infile(fileName(key), std::ios::binary);
+  if (!infile.is_open())
+    return false;
+
+  std::string header(magic.size(), '\0');
+  infile.read(&header[0], header.size());
+  std::uint64_t keySize = 0;
+  infile.read(reinterpret_cast<char *>(&keySize), sizeof(keySize));
+  if (!infile || header != magic || keySize != key.size())
+    return false;
+  std::string savedKey(keySize, '\0');
+  infile.read(&savedKey[0], keySize);
+  if (!infile || savedKey != key)
+    return false;
+
+  double L3;
+  if (!popln.readState(infile) ||
+      !infile.read(reinterpret_cast<char *>(&L3), sizeof(L3)) ||
+      !infile.read(reinterpret_cast<char *>(&steps), sizeof(steps))) {
+    std::cout << "Error in BurnInCache::restore. File " << fileName(key)
+              << " is incomplete" << std::endl;
+    exit(1);
+  }
+  vectors.L3 = L3;
+  return true;
+}
+
+void BurnInCache::save(const std::string &key, const Population &popln,
+                       const Vector &vectors, int steps) const {
+
+  // written under a name of its own then renamed, so other threads and
+  // processes never see a partial file
+  std::string fname = fileName(key);
+  std::ostringstream tmpName;
+  tmpName << fname << "." << getpid() << "."
+          << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+
+  std::ofstream outfile(tmpName.str(), std::ios::binary);
+  if (!outfile.is_open()) {
+    std::cout << "Error in BurnInCache::save. Cannot write file "
+              << tmpName.str() << std::endl;
+    exit(1);
+  }
+  std::uint64_t keySize = key.size();
+  outfile.write(magic.data(), magic.size());
+  outfile.write(reinterpret_cast<const char *>(&keySize), sizeof(keySize));
+  outfile.write(key.data(), key.size());
+  popln.writeState(outfile);
+  outfile.write(reinterpret_cast<const char *>(&vectors.L3),
+                sizeof(vectors.L3));
+  outfile.write(reinterpret_cast<const char *>(&steps), sizeof(steps));
+  outfile.close();
+  if (!outfile) {
+    std::cout << "Error in BurnInCache::save. Cannot write file "
+              << tmpName.str() << std::endl;
+    exit(1);
+  }
+  fs::rename(tmpName.str(), fname);
+}
@@ -0,0 +1,55 @@
+//
+//  BurnInCache.hpp
+//  transfil
+//
+//  On-disk store of the state reached at the end of a burn-in.
+//
+
+#ifndef BurnInCache_hpp
+#define BurnInCache_hpp
+
+#include <string>
+
+class Population;
+class Vector;
+class Worm;
+
+// The burn-in is fully determined by the ParamList, the replicate's random
+// parameters (population size, k, aImp, v_to_h, wPropMDA), its seed, the
+// time step and the rule for when it stops. Runs that share all of these, eg
+// the same IU rerun with new MDA scenarios, can restore the saved hosts,
+// random number generator and L3 density instead of simulating the burn-in
+// again.
+//
+// One file per burn-in, named by a hash of its key. The full key is kept in
+// the file and checked when it is read, so a hash collision is only a miss.
+
+class BurnInCache {
+
+public:
+  BurnInCache(std::string folder, std::string paramList);
+
+  // describes the burn-in about to be run on freshly initialised objects.
+  // rule says when the burn-in stops
+  std::string key(unsigned long int seed, const Population &popln,
+                  const Vector &vectors, const Worm &worms, double dt,
+                  std::string rule) const;
+
+  // true if the state for key was found and restored. steps is set to the
+  // number of steps the burn-in took
+  bool restore(const std::string &key, Population &popln, Vector &vectors,
+               int &steps) const;
+  void save(const std::string &key, const Population &popln,
+            const Vector &vectors, int steps) const;
+
+private:
+  std::string fileName(const std::string &key) const;
+
+  // bump when a change to the model alters the result of a burn-in
+  static const int version = 3;
+
+  std::string folder;
+  std::string paramList;
+};
+
+#endif /* BurnInCache_hpp */
@@ -0,0 +1,36 @@
+//
+//  CorrelatedNormal.cpp
+//  transfil
+//
+//  Draws from a 3 dimensional normal distribution, for the correlated
+//  compliance of hosts with MDA and bed nets.
+//
+
+#include "CorrelatedNormal.hpp"
+#include "Statistics.hpp"
+
+CorrelatedNormal::CorrelatedNormal(const double covariance[3][3]) {
+
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      factor[i][j] = covariance[i][j];
+
+  gsl_matrix_view work = gsl_matrix_view_array(&factor[0][0], 3, 3);
+  gsl_linalg_cholesky_decomp(&work.matrix); // decompose variance
+}
+
+void CorrelatedNormal::draw(const double mean[3], Statistics &stats,
+                            double result[3]) const {
+
+  double z[3];
+  for (int k = 0; k < 3; k++) // randomise result
+    z[k] = stats.unit_normal_dist();
+
+  // factor * z + mean, summed in the order gsl_blas_dtrmv does
+  for (int i = 0; i < 3; i++) {
+    double sum = 0.0;
+    for (int j = 0; j < i; j++)
+      sum += z[j] * factor[i][j];
+    result[i] = (sum + z[i] * factor[i][i]) + mean[i];
+  }
+}
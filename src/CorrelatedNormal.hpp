@@ -0,0 +1,30 @@
+//
+//  CorrelatedNormal.hpp
+//  transfil
+//
+//  Draws from a 3 dimensional normal distribution, for the correlated
+//  compliance of hosts with MDA and bed nets.
+//
+
+#ifndef CorrelatedNormal_hpp
+#define CorrelatedNormal_hpp
+
+class Statistics;
+
+// The covariance is factored once, when constructed, so each draw is 3 unit
+// normals and a triangular multiply, with nothing allocated. A draw gives the
+// same values as the rmvnorm it replaces, which factored the covariance with
+// gsl_linalg_cholesky_decomp and multiplied with gsl_blas_dtrmv every time.
+
+class CorrelatedNormal {
+
+public:
+  CorrelatedNormal(const double covariance[3][3]);
+
+  void draw(const double mean[3], Statistics &stats, double result[3]) const;
+
+private:
+  double factor[3][3]; // Cholesky factor in the lower triangle
+};
+
+#endif /* CorrelatedNormal_hpp */
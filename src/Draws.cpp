@@ -0,0 +1,261 @@
+//
+//  Draws.cpp
+//  transfil
+//
+//  Combines per-replicate csv output into one wide "draws" file.
+//
+
+#include "Draws.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <set>
+
+// how pandas would read a value
+enum CellKind { NACell, IntCell, FloatCell, TextCell };
+
+// how pandas would type a column. Ordered so that concatenating columns gives
+// the largest type
+enum ColumnType { IntColumn, FloatColumn, TextColumn };
+
+static CellKind cellKind(const std::string &s) {
+
+  // pandas' default missing value markers
+  static const std::set<std::string> missing = {
+      "",     "#N/A", "#N/A N/A", "#NA", "-1.#IND", "-1.#QNAN", "-NaN", "-nan",
+      "1.#IND", "1.#QNAN", "<NA>", "N/A", "NA",    "NULL",    "NaN",   "None",
+      "n/a",  "nan",  "null"};
+  if (missing.count(s))
+    return NACell;
+
+  std::size_t i = (s[0] == '-' || s[0] == '+') ? 1 : 0;
+  if (i < s.size() &&
+      std::all_of(s.begin() + i, s.end(), [](char c) { return isdigit(c); }))
+    return IntCell;
+
+  char *end;
+  strtod(s.c_str(), &end);
+  return (*end == '\0') ? FloatCell : TextCell;
+}
+
+static ColumnType kindType(CellKind kind) {
+
+  if (kind == TextCell)
+    return TextColumn;
+  if (kind == IntCell)
+    return IntColumn;
+  return FloatColumn;
+}
+
+std::string pythonFloat(double x) {
+
+  if (std::isnan(x))
+    return "nan";
+  if (std::isinf(x))
+    return (x < 0) ? "-inf" : "inf";
+
+  // shortest round trip digits and exponent, as d.ddde+XX
+  char buf[64];
+  char *end = std::to_chars(buf, buf + sizeof(buf), x,
+                            std::chars_format::scientific)
+                  .ptr;
+  std::string sci(buf, end);
+
+  std::string sign;
+  if (sci[0] == '-') {
+    sign = "-";
+    sci.erase(0, 1);
+  }
+  std::size_t e = sci.find('e');
+  int exponent = atoi(sci.c_str() + e + 1);
+  std::string digits = sci.substr(0, e);
+  digits.erase(std::remove(digits.begin(), digits.end(), '.'), digits.end());
+
+  // like repr, positional from 1e-4 up to 1e16 and scientific outside
+  if (exponent < -4 || exponent >= 16) {
+    std::string mantissa = digits.substr(0, 1);
+    if (digits.size() > 1)
+      mantissa += "." + digits.substr(1);
+    std::string exp = std::to_string(std::abs(exponent));
+    if (exp.size() < 2)
+      exp = "0" + exp;
+    return sign + mantissa + "e" + (exponent < 0 ? "-" : "+") + exp;
+  }
+  if (exponent < 0)
+    return sign + "0." + std::string(-exponent - 1, '0') + digits;
+  if ((int)digits.size() <= exponent + 1)
+    return sign + digits + std::string(exponent + 1 - digits.size(), '0') +
+           ".0";
+  return sign + digits.substr(0, exponent + 1) + "." +
+         digits.substr(exponent + 1);
+}
+
+// walks the non-blank lines of one replicate's csv text, as read_csv does
+class CsvLines {
+
+public:
+  CsvLines(const std::string *text) : text(text) {}
+
+  bool next(std::string &line) {
+    while (text && pos < text->size()) {
+      std::size_t eol = text->find('\n', pos);
+      if (eol == std::string::npos)
+        eol = text->size();
+      line = text->substr(pos, eol - pos);
+      pos = eol + 1;
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+      if (!line.empty())
+        return true;
+    }
+    return false;
+  }
+
+private:
+  const std::string *text;
+  std::size_t pos = 0;
+};
+
+static std::vector<std::string> splitFields(const std::string &line,
+                                            std::size_t numFields) {
+
+  std::vector<std::string> fields;
+  std::size_t start = 0;
+  while (fields.size() + 1 < numFields) {
+    std::size_t comma = line.find(',', start);
+    if (comma == std::string::npos)
+      break;
+    fields.push_back(line.substr(start, comma - start));
+    start = comma + 1;
+  }
+  fields.push_back(line.substr(start));
+  fields.resize(numFields); // missing fields read as missing values
+  return fields;
+}
+
+// one part of the output, ie the files of one type for all replicates
+typedef struct {
+
+  const ReplicateCsv *csv;
+  std::vector<std::string> header; // of replicate 0
+  int rows;
+  std::vector<ColumnType> types; // header columns then draw_1 ... draw_N-1
+
+} DrawsPart;
+
+static const std::string *replicateText(const ReplicateCsv &csv, int rep) {
+  return (rep < (int)csv.size()) ? &csv[rep] : NULL;
+}
+
+static std::string printCell(const std::string &token, ColumnType partType,
+                             ColumnType type) {
+
+  CellKind kind = cellKind(token);
+  if (kind == NACell)
+    return "";
+  if (type == TextColumn && partType == TextColumn)
+    return token;
+  if (type == FloatColumn || partType == FloatColumn)
+    return pythonFloat(strtod(token.c_str(), NULL));
+  return std::to_string(strtoll(token.c_str(), NULL, 10));
+}
+
+void writeDraws(std::ostream &out,
+                const std::vector<const ReplicateCsv *> &parts) {
+
+  if (parts.empty() || parts[0]->empty())
+    return;
+  int replicates = parts[0]->size();
+
+  // first pass: type every column of every part as read_csv would
+  std::vector<DrawsPart> drawsParts;
+  for (const ReplicateCsv *csv : parts) {
+
+    DrawsPart part;
+    part.csv = csv;
+    std::string line;
+
+    CsvLines rep0(replicateText(*csv, 0));
+    if (!rep0.next(line))
+      continue;
+    part.header =
+        splitFields(line, std::count(line.begin(), line.end(), ',') + 1);
+    std::size_t numFields = part.header.size();
+    std::vector<ColumnType> types(numFields, IntColumn);
+    part.rows = 0;
+    while (rep0.next(line)) {
+      std::vector<std::string> fields = splitFields(line, numFields);
+      for (std::size_t c = 0; c < numFields; c++)
+        types[c] = std::max(types[c], kindType(cellKind(fields[c])));
+      part.rows++;
+    }
+    part.types = types;
+
+    for (int rep = 1; rep < replicates; rep++) {
+      CsvLines lines(replicateText(*csv, rep));
+      ColumnType type = IntColumn;
+      int rows = 0;
+      if (lines.next(line)) // header
+        while (lines.next(line)) {
+          type = std::max(type, kindType(cellKind(splitFields(line, 1)[0])));
+          rows++;
+        }
+      // rows missing from a shorter file are missing values
+      if (rows < part.rows)
+        type = std::max(type, FloatColumn);
+      part.types.push_back(type);
+    }
+    drawsParts.push_back(part);
+  }
+  if (drawsParts.empty())
+    return;
+
+  // concatenating the parts promotes each column to the widest type
+  std::size_t numLabels = drawsParts[0].header.size();
+  std::vector<ColumnType> types = drawsParts[0].types;
+  for (const DrawsPart &part : drawsParts)
+    for (std::size_t c = 0; c < types.size() && c < part.types.size(); c++)
+      types[c] = std::max(types[c], part.types[c]);
+
+  // header
+  for (std::size_t c = 0; c < numLabels; c++)
+    out << (c ? "," : "") << drawsParts[0].header[c];
+  for (int rep = 1; rep < replicates; rep++)
+    out << ",draw_" << rep;
+  out << "\n";
+
+  // second pass: the rows, reading every replicate's file in step
+  for (const DrawsPart &part : drawsParts) {
+
+    std::vector<CsvLines> lines;
+    std::string line;
+    for (int rep = 0; rep < replicates; rep++) {
+      lines.emplace_back(replicateText(*part.csv, rep));
+      lines.back().next(line); // header
+    }
+
+    std::size_t numFields = part.header.size();
+    for (int row = 0; row < part.rows; row++) {
+
+      lines[0].next(line);
+      std::vector<std::string> fields = splitFields(line, numFields);
+      for (std::size_t c = 0; c < numLabels; c++) {
+        std::string token = (c < numFields) ? fields[c] : "";
+        out << (c ? "," : "")
+            << printCell(token, part.types[std::min(c, numFields - 1)],
+                         types[c]);
+      }
+
+      for (int rep = 1; rep < replicates; rep++) {
+        std::string token;
+        if (lines[rep].next(line))
+          token = splitFields(line, 1)[0];
+        out << ","
+            << printCell(token, part.types[numFields + rep - 1],
+                         types[numLabels + rep - 1]);
+      }
+      out << "\n";
+    }
+  }
+}
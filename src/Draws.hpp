@@ -0,0 +1,33 @@
+//
+//  Draws.hpp
+//  transfil
+//
+//  Combines per-replicate csv output into one wide "draws" file.
+//
+
+#ifndef Draws_hpp
+#define Draws_hpp
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// csv text of one output file for each replicate, indexed by replicate.
+// Replicate 0's text has the label columns espen_loc, year_id, age_start,
+// age_end and measure before draw_0, the others only have draw_0.
+typedef std::vector<std::string> ReplicateCsv;
+
+// Writes each part's replicates side by side as columns draw_0 ... draw_N-1,
+// with the parts one after another, to give the same file as
+// run/combine-lf-outputs.py. That script reads the csv files with pandas, so
+// the values are typed and printed as pandas would: a column holding any
+// missing value or decimal is printed as floats (eg 37.0), a column holding
+// any text is printed as written, and missing values (None, nan) are empty.
+void writeDraws(std::ostream &out,
+                const std::vector<const ReplicateCsv *> &parts);
+
+// x printed as Python/numpy print floats, the shortest text that reads back
+// as x, eg 37.0, 0.2, 1e-05
+std::string pythonFloat(double x);
+
+#endif /* Draws_hpp */
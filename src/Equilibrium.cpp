@@ -0,0 +1,40 @@
+//
+//  Equilibrium.cpp
+//  transfil
+//
+//  Detects when a burn-in has settled, so that it can stop early.
+//
+
+#include "Equilibrium.hpp"
+#include <algorithm>
+#include <cmath>
+
+void Equilibrium::addYear(double L3, double mfPrev, double meanWorms) {
+
+  years.push_back({L3, mfPrev, meanWorms});
+}
+
+bool Equilibrium::reached() const {
+
+  int n = years.size();
+  if (n < 2 * windowYears)
+    return false;
+
+  // means over the last two windows
+  reading before = {0, 0, 0}, last = {0, 0, 0};
+  for (int i = n - 2 * windowYears; i < n; i++) {
+    reading &sum = (i < n - windowYears) ? before : last;
+    sum.L3 += years[i].L3;
+    sum.mfPrev += years[i].mfPrev;
+    sum.meanWorms += years[i].meanWorms;
+  }
+
+  for (double reading::*value :
+       {&reading::L3, &reading::mfPrev, &reading::meanWorms}) {
+    double a = before.*value / windowYears;
+    double b = last.*value / windowYears;
+    if (std::fabs(a - b) > tolerance * std::max(std::fabs(a), std::fabs(b)))
+      return false;
+  }
+  return true;
+}
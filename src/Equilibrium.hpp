@@ -0,0 +1,40 @@
+//
+//  Equilibrium.hpp
+//  transfil
+//
+//  Detects when a burn-in has settled, so that it can stop early.
+//
+
+#ifndef Equilibrium_hpp
+#define Equilibrium_hpp
+
+#include <vector>
+
+// Takes one reading a year of L3 density, mf prevalence and mean worm burden.
+// Equilibrium is reached when, for each of them, the mean over the last
+// windowYears differs from the mean over the windowYears before by no more
+// than tolerance times the larger of the two. A population where infection
+// has died out is also at equilibrium.
+
+class Equilibrium {
+
+public:
+  Equilibrium(double tolerance, int windowYears = 10)
+      : tolerance(tolerance), windowYears(windowYears) {}
+
+  void addYear(double L3, double mfPrev, double meanWorms);
+  bool reached() const;
+
+private:
+  typedef struct {
+
+    double L3, mfPrev, meanWorms;
+
+  } reading;
+
+  double tolerance;
+  int windowYears;
+  std::vector<reading> years;
+};
+
+#endif /* Equilibrium_hpp */
@@ -13,10 +13,28 @@
 #include <climits>
 #include <iostream>
 
-extern Statistics stats;
+Host::Host() : Host(std::make_unique<HostStore>(1)) {}
+
+Host::Host(std::unique_ptr<HostStore> store) : Host(*store, 0) {
+  // keep the store alive for as long as this host references it
+  ownStore = std::move(store);
+}
+
+Host::Host(HostStore &store, int i)
+    : WM(store.WM[i]), WF(store.WF[i]), totalWorms(store.totalWorms[i]),
+      totalWormYears(store.totalWormYears[i]), M(store.M[i]),
+      biteRisk(store.biteRisk[i]), age(store.age[i]),
+      monthsSinceTreated(store.monthsSinceTreated[i]),
+      hydroMult(store.hydroMult[i]), lymphoMult(store.lymphoMult[i]),
+      sex(store.sex[i]), neverTreat(store.neverTreat[i]),
+      pTreat(store.pTreat[i]), bedNet(store.bedNet[i]),
+      uCompBednets(store.uCompBednets[i]), uCompMDA(store.uCompMDA[i]),
+      previouslyInfected(store.previouslyInfected[i]),
+      deathAt(store.deathAt[i]), importAt(store.importAt[i]),
+      numMDAs(store.numMDAs[i]) {}
 
 void Host::reset(int a, double HydroceleShape, double LymphodemaShape,
-                 double neverTreated) {
+                 double neverTreated, Statistics &stats) {
 
   // called when host dies and is reborn or initialised
 
@@ -37,7 +55,8 @@ void Host::reset(int a, double HydroceleShape, double LymphodemaShape,
 
 void Host::initialise(double deathRate, int maxAge, double k,
                       double *totalBiteRisk, double HydroceleShape,
-                      double LymphodemaShape, double neverTreated) {
+                      double LymphodemaShape, double neverTreated,
+                      Statistics &stats) {
 
   // called at start of new replicate
 
@@ -52,29 +71,35 @@ void Host::initialise(double deathRate, int maxAge, double k,
   hydroMult = stats.gamma_dist(HydroceleShape);
   lymphoMult = stats.gamma_dist(LymphodemaShape);
   sex = (stats.uniform_dist() < 0.5) ? 0 : 1;
-  reset(a, HydroceleShape, LymphodemaShape, neverTreated);
+  reset(a, HydroceleShape, LymphodemaShape, neverTreated, stats);
   pTreat = 0;
   previouslyInfected = -1;
 }
 
-void Host::initialisePTreat(double alpha, double beta) {
+void Host::initialisePTreat(double alpha, double beta, Statistics &stats) {
   pTreat = stats.beta_dist(alpha, beta);
 }
 
 void Host::react(double dt, double deathRate, const int maxAge, double aImp,
                  const Vector &vectors, const Worm &worms,
                  double HydroceleShape, double LymphodemaShape,
-                 double neverTreated) {
+                 double neverTreated, Statistics &stats,
+                 const eventClock *clock) {
   // double totalbites = 0;
   // time-step
   age += dt;
   totalWormYears += (WM + WF) * dt;
-  // each month 3 possible fates
+  // each month 3 possible fates. With the population's clock, deaths and
+  // importations happen when due rather than being drawn every step
 
-  if ((hostDies(deathRate * dt)) || age > (12 * maxAge)) { // if over age 100
+  bool dies =
+      clock ? clock->deaths >= deathAt : hostDies(deathRate * dt, stats);
+  if (dies || age > (12 * maxAge)) { // if over age 100
 
     // host dies and is replaced by uninfected newborn with same bite risk (b)
-    reset(0, HydroceleShape, LymphodemaShape, neverTreated);
+    reset(0, HydroceleShape, LymphodemaShape, neverTreated, stats);
+    if (clock)
+      scheduleEvents(*clock, stats);
 
   } else {
     // host lives on
@@ -84,7 +109,9 @@ void Host::react(double dt, double deathRate, const int maxAge, double aImp,
                       : 1.0; // increases with age up to 9 years. If < 9, scale
                              // downwards to account for smaller surface area
 
-    if (newImportation(aImp * dt)) {
+    bool imported = clock ? clock->imports >= importAt
+                          : newImportation(aImp * dt, stats);
+    if (imported) {
 
       // host leaves and is replaced by another individual of same age (a) and
       // bite risk infected with a breeding pair of worms but no microfilarae
@@ -106,6 +133,8 @@ void Host::react(double dt, double deathRate, const int maxAge, double aImp,
                                              // rate (default values make ~16)
       totalWorms = WM + WF;
       M = 0;
+      if (clock)
+        importAt = clock->imports + stats.exp_dist(1.0);
 
     } else {
 
@@ -166,23 +195,32 @@ void Host::react(double dt, double deathRate, const int maxAge, double aImp,
   }
 }
 
-bool Host::newImportation(double prob) {
+void Host::scheduleEvents(const eventClock &clock, Statistics &stats) {
+
+  // each hazard grows by rate * dt a step, so a unit exponential beyond the
+  // clock now gives the same chance of the event in each step as drawing a
+  // uniform against 1 - exp(-rate * dt) does, however the rate changes
+  deathAt = clock.deaths + stats.exp_dist(1.0);
+  importAt = clock.imports + stats.exp_dist(1.0);
+}
+
+bool Host::newImportation(double prob, Statistics &stats) {
 
   return stats.uniform_dist() < (1 - exp(-prob));
 }
 
-bool Host::hostDies(double prob) {
+bool Host::hostDies(double prob, Statistics &stats) {
 
   return stats.uniform_dist() < (1 - exp(-prob));
 }
 
-void Host::getsTreated(Worm &worms, std::string type) {
+void Host::getsTreated(const DrugRegimen &regimen) {
 
   // MDA kill portion of worms
 
-  M = worms.mfTreated(M, type);
-  WM = worms.wormsTreated(WM, type);
-  WF = worms.wormsTreated(WF, type);
+  M = M * (1 - regimen.mfKilled);
+  WM = int((1 - regimen.wormsKilled) * double(WM));
+  WF = int((1 - regimen.wormsKilled) * double(WF));
 
   numMDAs++;
 
@@ -194,7 +232,8 @@ Host::operator hostState() const {
   // save this object to the host state structure
   return {WM,        WF,         totalWorms, totalWormYears,
           M,         biteRisk,   age,        monthsSinceTreated,
-          hydroMult, lymphoMult, sex,        pTreat};
+          hydroMult, lymphoMult, sex,        pTreat,
+          deathAt,   importAt};
 }
 
 void Host::restore(const hostState &state) {
@@ -212,4 +251,6 @@ void Host::restore(const hostState &state) {
   lymphoMult = state.lymphoMult;
   sex = state.sex;
   pTreat = state.pTreat;
+  deathAt = state.deathAt;
+  importAt = state.importAt;
 }
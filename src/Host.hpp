@@ -9,10 +9,13 @@
 #ifndef Host_hpp
 #define Host_hpp
 
+#include "HostStore.hpp"
+#include "Worm.hpp"
+#include <memory>
 #include <string>
 
+class Statistics;
 class Vector;
-class Worm;
 
 typedef struct {
 
@@ -30,54 +33,86 @@ typedef struct {
   double pTreat; // probability of treatment drawn from a beta distribution as
                  // defined in section 1.5.3 of supplement to
                  // https://www.ncbi.nlm.nih.gov/pmc/articles/PMC5340860/
+  double deathAt, importAt;
 } hostState;
 
+typedef struct {
+
+  // cumulative death and importation hazards of a population since its hosts
+  // were initialised. A host's death or importation is due when the clock
+  // reaches the value drawn for it
+
+  double deaths;
+  double imports;
+
+} eventClock;
+
+// A view of one host in a HostStore. The state variables are references into
+// the store's columns, so a Host is cheap to construct on the fly for the
+// per-host update. A default constructed Host owns a store of one host.
+
 class Host {
 
   // operator to save a host
   //  friend hostState& operator<<(hostState& hs, const Host&);
 
+  // storage for a free-standing host, declared first so it exists before the
+  // references below are bound to it
+  std::unique_ptr<HostStore> ownStore;
+
 public:
+  Host();
+  Host(HostStore &store, int i);
+
   void initialise(double deathRate, int maxAge, double k, double *totalBiteRisk,
                   double HydroceleShape, double LymphodemaShape,
-                  double neverTreated); // initialise state variables.
+                  double neverTreated,
+                  Statistics &stats); // initialise state variables.
   void reset(int age, double HydroceleShape, double LymphodemaShape,
-             double neverTreated);
+             double neverTreated, Statistics &stats);
   void react(double dt, double deathRate, const int maxAge, double aImp,
              const Vector &vectors, const Worm &worms, double HydroceleShape,
-             double LymphodemaShape, double neverTreated);
-  void getsTreated(Worm &worms, std::string type);
+             double LymphodemaShape, double neverTreated, Statistics &stats,
+             const eventClock *clock = NULL);
+  // draw when the host next dies and is next replaced by an importation
+  void scheduleEvents(const eventClock &clock, Statistics &stats);
+  void getsTreated(const DrugRegimen &regimen);
   void restore(const hostState &state);
   int getNumMDAs() const { return numMDAs; };
-  void initialisePTreat(double alpha, double beta);
+  void initialisePTreat(double alpha, double beta, Statistics &stats);
   // state variables saved
-  int WM, WF; // number of male worms, number of female worms
-  int totalWorms;
-  double totalWormYears;
-  double M;                    // mf produced. //int
-  double biteRisk;             // mean number of bites per month
-  double age;                  // age of host.
-  unsigned monthsSinceTreated; // host has been treated if
-  double hydroMult;
-  double lymphoMult;
-  int sex; // 0 = male, 1 = female
-  int neverTreat;
-  double pTreat;
-  bool bedNet;         // host uses bednet.
-  double uCompBednets; // THe hosts probability of using a bednet for a given
-                       // overall coverage
-  double uCompMDA;
+  int &WM, &WF; // number of male worms, number of female worms
+  int &totalWorms;
+  double &totalWormYears;
+  double &M;                    // mf produced. //int
+  double &biteRisk;             // mean number of bites per month
+  double &age;                  // age of host.
+  unsigned &monthsSinceTreated; // host has been treated if
+  double &hydroMult;
+  double &lymphoMult;
+  int &sex; // 0 = male, 1 = female
+  int &neverTreat;
+  double &pTreat;
+  char &bedNet;         // host uses bednet.
+  double &uCompBednets; // THe hosts probability of using a bednet for a given
+                        // overall coverage
+  double &uCompMDA;
   // indicator whether the individual was infected at last time checked.
   // initialize at -1. Then will be set to 0 if uninfected and 1 if infected.
   // done at the start of each year
-  int previouslyInfected;
+  int &previouslyInfected;
+  // the values of the population's eventClock at which the host dies and is
+  // replaced by an importation. Only used when react is given the clock
+  double &deathAt;
+  double &importAt;
   // operator to save a host
   operator hostState() const;
 
 private:
-  bool newImportation(double prob);
-  bool hostDies(double prob);
-  int numMDAs;
+  bool newImportation(double prob, Statistics &stats);
+  bool hostDies(double prob, Statistics &stats);
+  Host(std::unique_ptr<HostStore> store);
+  int &numMDAs;
 };
 
 #endif /* Host_hpp */
@@ -0,0 +1,68 @@
+//
+//  HostSnapshot.cpp
+//  transfil
+//
+//  Saved host state for a month that later scenarios branch from.
+//
+
+#include "HostSnapshot.hpp"
+#include "HostStore.hpp"
+#include <algorithm>
+#include <cstring>
+
+// the columns a snapshot holds, in order
+template <typename Store, typename F>
+static void forEachSnapshotColumn(Store &hosts, bool all, F f) {
+  if (all)
+    hosts.forEachColumn(f);
+  else
+    hosts.forEachSavedColumn(f);
+}
+
+HostSnapshot::HostSnapshot(const HostStore &hosts, int size,
+                           const HostSnapshot *previous, bool allColumns)
+    : n(size), all(allColumns) {
+
+  // chunks can only be shared with a snapshot of the same hosts and columns
+  if (previous && (previous->n != n || previous->all != all))
+    previous = NULL;
+
+  forEachSnapshotColumn(hosts, all, [this, previous](const auto &column) {
+    std::size_t width = sizeof(column[0]);
+    const char *data = reinterpret_cast<const char *>(column.data());
+    const ChunkedColumn *before =
+        previous ? &previous->columns[columns.size()] : NULL;
+
+    ChunkedColumn chunks;
+    for (int start = 0; start < n; start += chunkSize) {
+      std::size_t bytes = std::min(chunkSize, n - start) * width;
+      const char *from = data + start * width;
+
+      std::shared_ptr<const Chunk> chunk;
+      if (before) {
+        const std::shared_ptr<const Chunk> &old = (*before)[start / chunkSize];
+        if (memcmp(old->data(), from, bytes) == 0)
+          chunk = old;
+      }
+      if (!chunk) {
+        chunk = std::make_shared<const Chunk>(from, from + bytes);
+        owned += bytes;
+      }
+      chunks.push_back(chunk);
+    }
+    columns.push_back(std::move(chunks));
+  });
+}
+
+void HostSnapshot::restore(HostStore &hosts) const {
+
+  std::size_t c = 0;
+  forEachSnapshotColumn(hosts, all, [this, &c](auto &column) {
+    char *data = reinterpret_cast<char *>(column.data());
+    for (const std::shared_ptr<const Chunk> &chunk : columns[c]) {
+      memcpy(data, chunk->data(), chunk->size());
+      data += chunk->size();
+    }
+    c++;
+  });
+}
@@ -0,0 +1,51 @@
+//
+//  HostSnapshot.hpp
+//  transfil
+//
+//  Saved host state for a month that later scenarios branch from.
+//
+
+#ifndef HostSnapshot_hpp
+#define HostSnapshot_hpp
+
+#include <memory>
+#include <vector>
+
+class HostStore;
+
+// The saved columns of a HostStore (see HostStore::forEachSavedColumn), each
+// cut into chunks of chunkSize hosts. A chunk that is unchanged since the
+// previous snapshot is shared with it instead of being copied, so a snapshot
+// only costs memory for the chunks that changed. Columns that change slowly,
+// such as bite risk and worm counts in uninfected hosts, are then mostly
+// shared, while age, which changes for every host every step, is not.
+
+class HostSnapshot {
+
+public:
+  HostSnapshot() {}
+  // save the first size hosts, sharing chunks with previous if it is not NULL.
+  // allColumns saves every column rather than just the saved ones
+  HostSnapshot(const HostStore &hosts, int size, const HostSnapshot *previous,
+               bool allColumns = false);
+
+  // copy the saved state back into the first size() hosts
+  void restore(HostStore &hosts) const;
+  int size() const { return n; }
+
+  // bytes held by chunks not shared with the previous snapshot
+  std::size_t bytesOwned() const { return owned; }
+
+private:
+  static const int chunkSize = 256;
+
+  typedef std::vector<char> Chunk;
+  typedef std::vector<std::shared_ptr<const Chunk>> ChunkedColumn;
+
+  std::vector<ChunkedColumn> columns;
+  int n = 0;
+  bool all = false;
+  std::size_t owned = 0;
+};
+
+#endif /* HostSnapshot_hpp */
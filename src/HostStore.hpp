@@ -0,0 +1,173 @@
+//
+//  HostStore.hpp
+//  transfil
+//
+//  Column-oriented storage for the state of the hosts in a population.
+//
+
+#ifndef HostStore_hpp
+#define HostStore_hpp
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Allocator for the host columns. Each column starts on a cache line boundary
+// so that the population-wide loops vectorise cleanly whatever the size of
+// the population.
+template <typename T> struct HostAllocator {
+
+  typedef T value_type;
+  static const std::size_t alignment = 64;
+
+  HostAllocator() = default;
+  template <typename U> HostAllocator(const HostAllocator<U> &) {}
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(alignment)));
+  }
+  void deallocate(T *p, std::size_t) {
+    ::operator delete(p, std::align_val_t(alignment));
+  }
+
+  template <typename U> bool operator==(const HostAllocator<U> &) const {
+    return true;
+  }
+  template <typename U> bool operator!=(const HostAllocator<U> &) const {
+    return false;
+  }
+};
+
+template <typename T> using HostColumn = std::vector<T, HostAllocator<T>>;
+
+// Each host state variable is held in its own contiguous array, indexed by
+// host. Loops over the whole population (evolve, larval uptake, prevalence,
+// bed net coverage) then only stream the columns they read. Host provides a
+// view of a single entry for the per-host logic in Host.cpp.
+class HostStore {
+
+public:
+  HostStore(int n = 0) { resize(n); }
+
+  void reserve(int n) {
+    WM.reserve(n);
+    WF.reserve(n);
+    totalWorms.reserve(n);
+    totalWormYears.reserve(n);
+    M.reserve(n);
+    biteRisk.reserve(n);
+    age.reserve(n);
+    monthsSinceTreated.reserve(n);
+    hydroMult.reserve(n);
+    lymphoMult.reserve(n);
+    sex.reserve(n);
+    neverTreat.reserve(n);
+    pTreat.reserve(n);
+    bedNet.reserve(n);
+    uCompBednets.reserve(n);
+    uCompMDA.reserve(n);
+    previouslyInfected.reserve(n);
+    numMDAs.reserve(n);
+    deathAt.reserve(n);
+    importAt.reserve(n);
+  }
+
+  void resize(int n) {
+    WM.resize(n);
+    WF.resize(n);
+    totalWorms.resize(n);
+    totalWormYears.resize(n);
+    M.resize(n);
+    biteRisk.resize(n);
+    age.resize(n);
+    monthsSinceTreated.resize(n);
+    hydroMult.resize(n);
+    lymphoMult.resize(n);
+    sex.resize(n);
+    neverTreat.resize(n);
+    pTreat.resize(n);
+    bedNet.resize(n);
+    uCompBednets.resize(n);
+    uCompMDA.resize(n);
+    previouslyInfected.resize(n);
+    numMDAs.resize(n);
+    deathAt.resize(n);
+    importAt.resize(n);
+  }
+
+  int size() const { return (int)M.size(); }
+
+  // call f on each column in turn, eg to save or restore the whole store
+  template <typename F> void forEachColumn(F f) {
+    f(WM);
+    f(WF);
+    f(totalWorms);
+    f(totalWormYears);
+    f(M);
+    f(biteRisk);
+    f(age);
+    f(monthsSinceTreated);
+    f(hydroMult);
+    f(lymphoMult);
+    f(sex);
+    f(neverTreat);
+    f(pTreat);
+    f(bedNet);
+    f(uCompBednets);
+    f(uCompMDA);
+    f(previouslyInfected);
+    f(numMDAs);
+    f(deathAt);
+    f(importAt);
+  }
+  template <typename F> void forEachColumn(F f) const {
+    const_cast<HostStore *>(this)->forEachColumn(
+        [&f](const auto &column) { f(column); });
+  }
+
+  // call f on the columns that are saved when a scenario branches, the same
+  // variables as Host's hostState
+  template <typename F> void forEachSavedColumn(F f) {
+    f(WM);
+    f(WF);
+    f(totalWorms);
+    f(totalWormYears);
+    f(M);
+    f(biteRisk);
+    f(age);
+    f(monthsSinceTreated);
+    f(hydroMult);
+    f(lymphoMult);
+    f(sex);
+    f(pTreat);
+    f(deathAt);
+    f(importAt);
+  }
+  template <typename F> void forEachSavedColumn(F f) const {
+    const_cast<HostStore *>(this)->forEachSavedColumn(
+        [&f](const auto &column) { f(column); });
+  }
+
+  // see Host.hpp for the meaning of each column
+  HostColumn<int> WM, WF;
+  HostColumn<int> totalWorms;
+  HostColumn<double> totalWormYears;
+  HostColumn<double> M;
+  HostColumn<double> biteRisk;
+  HostColumn<double> age;
+  HostColumn<unsigned> monthsSinceTreated;
+  HostColumn<double> hydroMult;
+  HostColumn<double> lymphoMult;
+  HostColumn<int> sex;
+  HostColumn<int> neverTreat;
+  HostColumn<double> pTreat;
+  HostColumn<char> bedNet; // char rather than bool so Host can reference it
+  HostColumn<double> uCompBednets;
+  HostColumn<double> uCompMDA;
+  HostColumn<int> previouslyInfected;
+  HostColumn<int> numMDAs;
+  HostColumn<double> deathAt, importAt;
+};
+
+#endif /* HostStore_hpp */
@@ -0,0 +1,197 @@
+//
+//  LarvalUptake.cpp
+//  transfil
+//
+//  Kernel for the uptake of mf by the vector population, see
+//  Population::getLarvalUptakebyVector.
+//
+
+#include "LarvalUptake.hpp"
+#include <cmath>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+// the species test is a template parameter so that it is resolved outside the
+// loop over hosts
+
+template <bool squared>
+static double uptakeScalar(const double *M, const double *biteRisk, int n,
+                           double r1, double kappas1) {
+
+  double mf = 0.0;
+  double uptake;
+  double TotalBiteRisk = 0;
+  for (int i = 0; i < n; i++) {
+
+    uptake = (1 - exp(-r1 * M[i] / kappas1));
+    if (squared)
+      uptake *= uptake;
+    mf += biteRisk[i] * kappas1 * uptake;
+    TotalBiteRisk += biteRisk[i];
+  }
+  return mf / TotalBiteRisk;
+}
+
+double larvalUptakeScalar(const double *M, const double *biteRisk, int n,
+                          double r1, double kappas1, bool squared) {
+
+  if (squared)
+    return uptakeScalar<true>(M, biteRisk, n, r1, kappas1);
+  return uptakeScalar<false>(M, biteRisk, n, r1, kappas1);
+}
+
+// Vector exp. Cephes range reduction x = k ln2 + r and Pade approximation of
+// exp(r), good to about 1 ulp. The argument here is never positive, so only
+// the lower end is clamped; below -708 the result is (nearly) zero anyway.
+
+static const double expLowest = -708.3;
+static const double expLog2e = 1.4426950408889634073599;
+static const double expC1 = 6.93145751953125E-1;
+static const double expC2 = 1.42860682030941723212E-6;
+static const double expP0 = 1.26177193074810590878E-4;
+static const double expP1 = 3.02994407707441961300E-2;
+static const double expP2 = 9.99999999999999999910E-1;
+static const double expQ0 = 3.00198505138664455042E-6;
+static const double expQ1 = 2.52448340349684104192E-3;
+static const double expQ2 = 2.27265548208155028766E-1;
+static const double expQ3 = 2.00000000000000000009E0;
+
+#if defined(__AVX512F__)
+
+static inline __m512d exp512(__m512d x) {
+
+  x = _mm512_max_pd(x, _mm512_set1_pd(expLowest));
+  __m512d k = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(expLog2e)),
+                                   _MM_FROUND_TO_NEAREST_INT);
+  x = _mm512_fnmadd_pd(k, _mm512_set1_pd(expC1), x);
+  x = _mm512_fnmadd_pd(k, _mm512_set1_pd(expC2), x);
+
+  __m512d xx = _mm512_mul_pd(x, x);
+  __m512d px = _mm512_fmadd_pd(_mm512_set1_pd(expP0), xx, _mm512_set1_pd(expP1));
+  px = _mm512_fmadd_pd(px, xx, _mm512_set1_pd(expP2));
+  px = _mm512_mul_pd(px, x);
+  __m512d qx = _mm512_fmadd_pd(_mm512_set1_pd(expQ0), xx, _mm512_set1_pd(expQ1));
+  qx = _mm512_fmadd_pd(qx, xx, _mm512_set1_pd(expQ2));
+  qx = _mm512_fmadd_pd(qx, xx, _mm512_set1_pd(expQ3));
+
+  // exp(r) = 1 + 2 px / (qx - px), then scale by 2^k
+  __m512d e = _mm512_div_pd(px, _mm512_sub_pd(qx, px));
+  e = _mm512_fmadd_pd(e, _mm512_set1_pd(2.0), _mm512_set1_pd(1.0));
+  return _mm512_scalef_pd(e, k);
+}
+
+template <bool squared>
+static double uptakeSIMD(const double *M, const double *biteRisk, int n,
+                         double r1, double kappas1) {
+
+  const __m512d scale = _mm512_set1_pd(-r1 / kappas1);
+  const __m512d one = _mm512_set1_pd(1.0);
+  __m512d mf = _mm512_setzero_pd();
+  __m512d totalBiteRisk = _mm512_setzero_pd();
+
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512d b = _mm512_loadu_pd(biteRisk + i);
+    __m512d uptake =
+        _mm512_sub_pd(one, exp512(_mm512_mul_pd(scale, _mm512_loadu_pd(M + i))));
+    if (squared)
+      uptake = _mm512_mul_pd(uptake, uptake);
+    mf = _mm512_fmadd_pd(b, uptake, mf);
+    totalBiteRisk = _mm512_add_pd(totalBiteRisk, b);
+  }
+
+  double mfSum = _mm512_reduce_add_pd(mf);
+  double biteRiskSum = _mm512_reduce_add_pd(totalBiteRisk);
+  for (; i < n; i++) {
+    double uptake = 1 - exp(-r1 / kappas1 * M[i]);
+    if (squared)
+      uptake *= uptake;
+    mfSum += biteRisk[i] * uptake;
+    biteRiskSum += biteRisk[i];
+  }
+  return kappas1 * mfSum / biteRiskSum;
+}
+
+#elif defined(__AVX2__) && defined(__FMA__)
+
+static inline __m256d exp256(__m256d x) {
+
+  x = _mm256_max_pd(x, _mm256_set1_pd(expLowest));
+  __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(expLog2e)),
+                              _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  x = _mm256_fnmadd_pd(k, _mm256_set1_pd(expC1), x);
+  x = _mm256_fnmadd_pd(k, _mm256_set1_pd(expC2), x);
+
+  __m256d xx = _mm256_mul_pd(x, x);
+  __m256d px = _mm256_fmadd_pd(_mm256_set1_pd(expP0), xx, _mm256_set1_pd(expP1));
+  px = _mm256_fmadd_pd(px, xx, _mm256_set1_pd(expP2));
+  px = _mm256_mul_pd(px, x);
+  __m256d qx = _mm256_fmadd_pd(_mm256_set1_pd(expQ0), xx, _mm256_set1_pd(expQ1));
+  qx = _mm256_fmadd_pd(qx, xx, _mm256_set1_pd(expQ2));
+  qx = _mm256_fmadd_pd(qx, xx, _mm256_set1_pd(expQ3));
+
+  // exp(r) = 1 + 2 px / (qx - px)
+  __m256d e = _mm256_div_pd(px, _mm256_sub_pd(qx, px));
+  e = _mm256_fmadd_pd(e, _mm256_set1_pd(2.0), _mm256_set1_pd(1.0));
+
+  // scale by 2^k, building the double 2^k from its biased exponent. k is at
+  // least -1022 after the clamp above so the result is never subnormal
+  __m128i k32 = _mm256_cvtpd_epi32(k);
+  __m256i biased = _mm256_add_epi64(_mm256_cvtepi32_epi64(k32),
+                                    _mm256_set1_epi64x(1023));
+  __m256d pow2k = _mm256_castsi256_pd(_mm256_slli_epi64(biased, 52));
+  return _mm256_mul_pd(e, pow2k);
+}
+
+static inline double sum256(__m256d v) {
+  __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+template <bool squared>
+static double uptakeSIMD(const double *M, const double *biteRisk, int n,
+                         double r1, double kappas1) {
+
+  const __m256d scale = _mm256_set1_pd(-r1 / kappas1);
+  const __m256d one = _mm256_set1_pd(1.0);
+  __m256d mf = _mm256_setzero_pd();
+  __m256d totalBiteRisk = _mm256_setzero_pd();
+
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d b = _mm256_loadu_pd(biteRisk + i);
+    __m256d uptake =
+        _mm256_sub_pd(one, exp256(_mm256_mul_pd(scale, _mm256_loadu_pd(M + i))));
+    if (squared)
+      uptake = _mm256_mul_pd(uptake, uptake);
+    mf = _mm256_fmadd_pd(b, uptake, mf);
+    totalBiteRisk = _mm256_add_pd(totalBiteRisk, b);
+  }
+
+  double mfSum = sum256(mf);
+  double biteRiskSum = sum256(totalBiteRisk);
+  for (; i < n; i++) {
+    double uptake = 1 - exp(-r1 / kappas1 * M[i]);
+    if (squared)
+      uptake *= uptake;
+    mfSum += biteRisk[i] * uptake;
+    biteRiskSum += biteRisk[i];
+  }
+  return kappas1 * mfSum / biteRiskSum;
+}
+
+#endif
+
+double larvalUptake(const double *M, const double *biteRisk, int n, double r1,
+                    double kappas1, bool squared) {
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+  if (squared)
+    return uptakeSIMD<true>(M, biteRisk, n, r1, kappas1);
+  return uptakeSIMD<false>(M, biteRisk, n, r1, kappas1);
+#else
+  return larvalUptakeScalar(M, biteRisk, n, r1, kappas1, squared);
+#endif
+}
@@ -0,0 +1,25 @@
+//
+//  LarvalUptake.hpp
+//  transfil
+//
+//  Kernel for the uptake of mf by the vector population, see
+//  Population::getLarvalUptakebyVector.
+//
+
+#ifndef LarvalUptake_hpp
+#define LarvalUptake_hpp
+
+// Bite risk weighted mean over n hosts of kappas1 * (1 - exp(-r1 * M /
+// kappas1)), with the uptake squared if squared is true (Anopheles).
+// M and biteRisk are the hosts' mf concentrations and bite risks.
+//
+// larvalUptake uses the AVX-512 or AVX2 kernel when the build targets a CPU
+// with those instructions (see NATIVE_ARCH in CMakeLists.txt) and otherwise
+// the scalar kernel. The SIMD kernels use their own exp and summation order
+// so agree with the scalar kernel to rounding error only.
+double larvalUptake(const double *M, const double *biteRisk, int n, double r1,
+                    double kappas1, bool squared);
+double larvalUptakeScalar(const double *M, const double *biteRisk, int n,
+                          double r1, double kappas1, bool squared);
+
+#endif /* LarvalUptake_hpp */
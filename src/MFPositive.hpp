@@ -0,0 +1,44 @@
+//
+//  MFPositive.hpp
+//  transfil
+//
+//  Each host's probability of testing mf positive, kept while M is unchanged.
+//
+
+#ifndef MFPositive_hpp
+#define MFPositive_hpp
+
+#include "HostStore.hpp"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// 1 - exp(-M) for each host, worked out the first time it is asked for after
+// M last changed. Several prevalence estimators run in the same month on the
+// same M, and each then reuses the others' values. Population calls changed()
+// whenever it alters M.
+
+class MFPositive {
+
+public:
+  void changed() { valid = false; }
+
+  double operator()(const HostStore &hosts, int i) {
+    if (!valid) {
+      prob.assign(hosts.M.size(), unknown);
+      valid = true;
+    }
+    double &p = prob[i];
+    if (std::isnan(p))
+      p = 1 - exp(-1 * hosts.M[i]); // depends on how many mf present
+    return p;
+  }
+
+private:
+  static constexpr double unknown = std::numeric_limits<double>::quiet_NaN();
+
+  std::vector<double> prob;
+  bool valid = false;
+};
+
+#endif /* MFPositive_hpp */
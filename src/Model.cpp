@@ -7,22 +7,51 @@
 //
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "Model.hpp"
+#include "AgeCensus.hpp"
+#include "BurnInCache.hpp"
+#include "Equilibrium.hpp"
 #include "Population.hpp"
+#include "RandomParameters.hpp"
 #include "RecordedPrevalence.hpp"
+#include "ReplicateStopping.hpp"
 #include "Scenario.hpp"
 #include "ScenariosList.hpp"
+#include "TaskPool.hpp"
 #include "Vector.hpp"
 #include "Worm.hpp"
 
 extern bool _DEBUG;
-extern Statistics stats;
+
+// a replicate at the start of one of its scenarios. Each branch has its own
+// copy of the state so that scenarios can run at the same time
+struct ReplicateBranch {
+
+  ReplicateBranch(const Population &popln, const Vector &vectors,
+                  const Worm &worms, const Output &output)
+      : popln(popln), vectors(vectors), worms(worms), output(output) {}
+
+  Population popln;
+  Vector vectors;
+  Worm worms;
+  Output output;
+
+  int rep = 0;
+  unsigned long int seed = 0;
+  double cov_prop = 1.0;
+  int currentMonth = 0;
+  std::vector<double> k_vals, v_to_h_vals, aImp_vals, wPropMDA;
+};
 
 void Model::runScenarios(ScenariosList &scenarios, Population &popln,
                          Vector &vectors, Worm &worms, int replicates,
@@ -30,145 +59,498 @@ void Model::runScenarios(ScenariosList &scenarios, Population &popln,
                          int outputEndgameDate, bool outputNTDMC,
                          int outputNTDMCDate, int reduceImpViaXml,
                          std::string randParamsfile, std::string RandomSeedFile,
-                         std::string RandomCovPropFile, std::string opDir) {
+                         std::string RandomCovPropFile, std::string opDir,
+                         int threads, BurnInCache *burnInCache) {
 
   std::cout << std::endl
             << "Index " << index << " running " << scenarios.getName()
             << " with " << scenarios.getNumScenarios() << " scenarios"
             << std::endl;
 
-  std::cout << std::unitbuf;
-  std::cout << "Progress:  0%";
+  if (showProgress) {
+    std::cout << std::unitbuf;
+    std::cout << "Progress:  0%";
+  }
 
   Output currentOutput(scenarios.getBaseYear());
-  currentOutput.saveRandomNames(printSeedName());
-  currentOutput.saveRandomNames(popln.printRandomVariableNames());
-  currentOutput.saveRandomNames(
-      vectors.printRandomVariableNames()); // names of random vars to be printed
-  currentOutput.saveRandomNames(worms.printRandomVariableNames());
 
   dt = timestep;
+  this->burnInCache = burnInCache;
 
   scenarios.openFilesandPrintHeadings(index, currentOutput);
 
-  std::vector<double> k_vals;
-  std::vector<double> v_to_h_vals;
-  std::vector<double> aImp_vals;
-  std::vector<double> wPropMDA;
   std::vector<unsigned long int> seeds;
   // we read in the entries of the random seed file. a different value will be
   // used for each set of parameters
   readSeedsFromFile(seeds, unsigned(replicates), RandomSeedFile);
+  // the two replicates of an antithetic pair need the same seed, so without
+  // a seed file they are drawn now rather than as each replicate starts
+  if (antitheticPairs && seeds.empty()) {
+    unsigned long int clock =
+        std::chrono::system_clock::now().time_since_epoch().count();
+    for (int rep = 0; rep < replicates; rep++)
+      seeds.push_back(Statistics::streamSeed(clock, rep));
+  }
 
   std::vector<double> cov_props;
   // we read in the entries of the random cov_props file. a different value will
   // be used for each set of parameters
   readCovPropFromFile(cov_props, unsigned(replicates), RandomCovPropFile);
 
-  for (int rep = 0; rep < replicates; rep++) {
-    // Read the seed from the seeds vector if it has been generated
-    // othewise we set a random seed
-    unsigned long int rseed;
-    if (seeds.size() > 0) {
-      rseed = seeds[rep];
-      stats.set_seed(rseed);
-    } else {
-      rseed = std::chrono::system_clock::now().time_since_epoch().count();
-      stats.set_seed(rseed);
+  // one line of parameters per replicate, read once for all of them
+  RandomParameters randParams;
+  randParams.load(randParamsfile, unsigned(replicates));
+
+  // with a stopping rule, replicates are run in rounds of stoppingRound and
+  // the precision checked after each. Otherwise they are all one round
+  std::unique_ptr<ReplicateStopping> stopper;
+  if (stoppingHalfWidth > 0)
+    stopper = std::make_unique<ReplicateStopping>(
+        stoppingHalfWidth, scenarios.getNumScenarios(), antitheticPairs);
+  stopping = stopper.get();
+  int round = stopping ? stoppingRound : replicates;
+
+  // replicates are handed out one at a time to each worker thread as it
+  // becomes free. Every replicate reseeds the generator of the population it
+  // runs on, so results don't depend on which thread that is or on the number
+  // of threads
+  if (!forkScenarios)
+    threads = std::max(1, std::min(threads, round));
+
+  std::atomic<int> nextRep(0);
+  int lastRep = 0;
+  int repsDone = 0;
+  std::mutex progressMutex;
+
+  auto worker = [&](Population &workerPopln, Vector &workerVectors,
+                    Worm &workerWorms) {
+    Model workerModel;
+    workerModel.dt = dt;
+    workerModel.burnInCache = burnInCache;
+    workerModel.setEquilibriumBurnIn(equilibriumTolerance, minBurnInYears);
+    workerModel.setCommonRandomNumbers(commonRandomNumbers);
+    workerModel.setAntitheticPairs(antitheticPairs);
+    workerModel.setSequentialStopping(stoppingHalfWidth, stoppingYear);
+    workerModel.stopping = stopping;
+
+    Output workerOutput =
+        newOutput(scenarios, workerPopln, workerVectors, workerWorms);
+
+    std::vector<double> k_vals;
+    std::vector<double> v_to_h_vals;
+    std::vector<double> aImp_vals;
+    std::vector<double> wPropMDA;
+
+    int rep;
+    while ((rep = nextRep++) < lastRep) {
+
+      workerModel.runReplicate(
+          rep, scenarios, workerPopln, workerVectors, workerWorms, workerOutput,
+          seeds, cov_props, k_vals, v_to_h_vals, aImp_vals, wPropMDA,
+          replicates, outputEndgame, outputEndgameDate, outputNTDMC,
+          outputNTDMCDate, reduceImpViaXml, randParams, opDir);
+
+      if (!_DEBUG && showProgress) {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        std::cout << "\b\b\b\b";
+        std::cout << std::setw(3) << int(repsDone++ * 100 / replicates) << "%";
+      }
     }
-    // Read the value to multiply the MDA's by if this has been supplied
-    // othewise we set this to 1
-    double cov_prop;
-    if (cov_props.size() > 0) {
-      cov_prop = cov_props[rep];
-    } else {
-      cov_prop = 1.0;
+  };
+
+  // the first worker uses the objects passed in, the others get their own
+  // copies taken before any replicate starts
+  std::vector<Population> poplns(forkScenarios ? 0 : threads - 1, popln);
+  std::vector<Vector> vectorsCopies(forkScenarios ? 0 : threads - 1, vectors);
+  std::vector<Worm> wormsCopies(forkScenarios ? 0 : threads - 1, worms);
+
+  int repsRun = 0;
+  while (repsRun < replicates) {
+
+    lastRep = std::min(repsRun + round, replicates);
+    if (forkScenarios)
+      runForkedScenarios(scenarios, popln, vectors, worms, replicates, seeds,
+                         cov_props, repsRun, lastRep, outputEndgame,
+                         outputEndgameDate, outputNTDMC, outputNTDMCDate,
+                         reduceImpViaXml, randParams, opDir, threads);
+    else {
+      nextRep = repsRun;
+      std::vector<std::thread> workers;
+      for (int i = 0; i < threads - 1; i++)
+        workers.emplace_back(worker, std::ref(poplns[i]),
+                             std::ref(vectorsCopies[i]),
+                             std::ref(wormsCopies[i]));
+
+      worker(popln, vectors, worms);
+
+      for (std::thread &w : workers)
+        w.join();
     }
-    getRandomParametersMultiplePerLine(rep + 1, k_vals, v_to_h_vals, aImp_vals,
-                                       wPropMDA, unsigned(replicates),
-                                       randParamsfile);
-    currentMonth = 0;
-    popln.clearSavedMonths();
-    vectors.clearSavedMonths();
-    currentOutput.initialise(); // delete previous replicate
-
-    // functions temporarily altered to allow random value to be passed in
-
-    std::string distType = stats.selectDistribType();
-    // create a new host population with random size, ages and compliance p vals
-    // and bite risk. Generates new value for k and aImp
-    // popln.initHosts(distType, k_vals[rep], aImp_vals[rep]);
-    popln.initHosts(distType, k_vals[0], aImp_vals[0]);
-    // generate vector to host ratio value and reset L3 to initial value
-    // vectors.reset(distType, v_to_h_vals[rep]);
-    vectors.reset(distType, v_to_h_vals[0]);
-
-    // tmp fix to set wPropMDA
-    // worms.reset(wPropMDA[rep]);
-    worms.reset(wPropMDA[0]);
-
-    // save these values for printing later
-    currentOutput.clearRandomValues();
-    // MUST be cvalled i nsame order as saveRandomNames above
-    currentOutput.saveSeedValue(rseed);
-    currentOutput.saveRandomValues(popln.printRandomVariableValues());
-    currentOutput.saveRandomValues(vectors.printRandomVariableValues());
-    currentOutput.saveRandomValues(worms.printRandomVariableValues());
-
-    // baseline prevalence
-    PrevalenceEvent pe = PrevalenceEvent(
-        popln.getMinAgePrev(), scenarios.getExtraMinAge(),
-        scenarios.getExtraMaxAge(),
-        scenarios.getOutputtMethod()); // default age range and method to output
-                                       // at end of burn in
-    burnIn(popln, vectors, worms, currentOutput,
-           &pe); // should be at least 100 years
-    // Run each scenario
-    for (unsigned s = 0; s < scenarios.getNumScenarios(); s++) {
-
-      Scenario &sc = scenarios[s];
-
-      if (_DEBUG)
-        std::cout << std::endl
-                  << sc.getName() << " starts month " << sc.getStartMonth()
-                  << std::endl;
-
-      if (sc.getStartMonth() != currentMonth) {
-
-        // reset to the start of this month
-        currentMonth = sc.getStartMonth();
-        // reset to the start of currentMonth
-        popln.resetToMonth(currentMonth);   // worms and aImp
-        vectors.resetToMonth(currentMonth); // L3
-
-        // delete any results with a month >= to this month
-        currentOutput.resetToMonth(currentMonth); // MDA and prev
-      }
+    repsRun = lastRep;
+
+    if (stopping && stopping->precise(repsRun))
+      break;
+  }
+
+  if (stopping)
+    writePrecision(scenarios, index, repsRun);
+  stopping = NULL;
+
+  scenarios.writeDraws();
+  scenarios.closeFiles();
+  // finished
+}
+
+Output Model::newOutput(ScenariosList &scenarios, const Population &popln,
+                        const Vector &vectors, const Worm &worms) const {
+
+  Output output(scenarios.getBaseYear());
+  output.saveRandomNames(printSeedName());
+  output.saveRandomNames(popln.printRandomVariableNames());
+  output.saveRandomNames(
+      vectors.printRandomVariableNames()); // names of random vars to be printed
+  output.saveRandomNames(worms.printRandomVariableNames());
+  if (equilibriumTolerance > 0)
+    output.saveRandomNames({"burnInYears"});
+  return output;
+}
+
+void Model::runForkedScenarios(
+    ScenariosList &scenarios, const Population &popln, const Vector &vectors,
+    const Worm &worms, int replicates,
+    const std::vector<unsigned long int> &seeds,
+    const std::vector<double> &cov_props, int firstRep, int lastRep,
+    int outputEndgame, int outputEndgameDate, bool outputNTDMC,
+    int outputNTDMCDate, int reduceImpViaXml,
+    const RandomParameters &randParams, std::string opDir, int threads) {
+
+  // Each replicate's scenarios form a tree: a scenario starts either from the
+  // end of the burn-in or from a month saved by an earlier scenario. When a
+  // scenario reaches such a month, the scenarios starting there are forked
+  // off with a copy of its state and queued to run on any free thread. The
+  // first scenario starting from the burn-in carries on with the replicate's
+  // random number stream, so it gives the same results as without forking.
+  // Every other scenario gets a stream of its own, seeded from the replicate
+  // seed and its position in the list, so its results don't depend on the
+  // number of threads.
+  for (unsigned s = 0; s < scenarios.getNumScenarios(); s++)
+    if (scenarios.getParent(s) < 0 && scenarios[s].getStartMonth() != 0) {
+      std::cout << "Error in Model::runForkedScenarios. Scenario "
+                << scenarios[s].getName()
+                << " does not start from a month saved by an earlier scenario"
+                << std::endl;
+      exit(1);
+    }
+
+  TaskPool pool(std::max(1, threads));
+  const Output outputTemplate = newOutput(scenarios, popln, vectors, worms);
+
+  int runsDone = firstRep * scenarios.getNumScenarios();
+  int runs = replicates * scenarios.getNumScenarios();
+  std::mutex progressMutex;
+
+  Fork fork = [&](std::shared_ptr<ReplicateBranch> branch, int s) {
+    pool.add([&, branch, s](int) {
+      Model branchModel = *this;
+      branchModel.runBranch(branch, s, scenarios, fork, outputEndgame,
+                            outputEndgameDate, outputNTDMC, outputNTDMCDate,
+                            reduceImpViaXml, opDir);
 
-      // evolve, saving any specified months along the way
-      for (int y = 0; y < sc.getNumMonthsToSave(); y++) {
-        evolveAndSave(y, popln, vectors, worms, sc, currentOutput, rep, k_vals,
-                      v_to_h_vals, popln.getUpdateParams(), outputEndgame,
-                      outputEndgameDate, outputNTDMC, outputNTDMCDate,
-                      reduceImpViaXml, opDir, cov_prop);
+      if (!_DEBUG && showProgress) {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        std::cout << "\b\b\b\b";
+        std::cout << std::setw(3) << int(runsDone++ * 100 / runs) << "%";
       }
+    });
+  };
+
+  // queued last to first, so firstRep is taken first
+  for (int rep = lastRep - 1; rep >= firstRep; rep--)
+    pool.add([&, rep](int) {
+      std::shared_ptr<ReplicateBranch> root = std::make_shared<ReplicateBranch>(
+          popln, vectors, worms, outputTemplate);
+      Model repModel = *this;
+      root->rep = rep;
+      repModel.startReplicate(rep, scenarios, root->popln, root->vectors,
+                              root->worms, root->output, seeds, cov_props,
+                              root->k_vals, root->v_to_h_vals, root->aImp_vals,
+                              root->wPropMDA, replicates, randParams,
+                              root->seed, root->cov_prop);
+      root->currentMonth = repModel.currentMonth;
+      repModel.forkChildren(root, -1, false, scenarios, fork);
+    });
+
+  pool.run();
+}
+
+void Model::runBranch(std::shared_ptr<ReplicateBranch> branch, int s,
+                      ScenariosList &scenarios, const Fork &fork,
+                      int outputEndgame, int outputEndgameDate,
+                      bool outputNTDMC, int outputNTDMCDate,
+                      int reduceImpViaXml, std::string opDir) {
+
+  Scenario &sc = scenarios[s];
+  currentMonth = branch->currentMonth;
+
+  // evolve, forking any scenarios that start from the months saved
+  for (int y = 0; y < sc.getNumMonthsToSave(); y++) {
+    evolveAndSave(y, branch->popln, branch->vectors, branch->worms, sc,
+                  branch->output, branch->rep, branch->k_vals,
+                  branch->v_to_h_vals, branch->popln.getUpdateParams(),
+                  outputEndgame, outputEndgameDate, outputNTDMC,
+                  outputNTDMCDate, reduceImpViaXml, opDir, branch->cov_prop);
+    branch->currentMonth = currentMonth;
+    if (y < sc.getNumMonthsToSave() - 1)
+      forkChildren(branch, s, true, scenarios, fork);
+  }
 
-      // done for this scenario, save the prevalence values for this replicate
-      if (!_DEBUG)
-        sc.printResults(rep, currentOutput, popln);
+  // this scenario's per-replicate csv files are complete
+  sc.closeOutputFiles(branch->rep);
 
-      if (_DEBUG)
-        popln.printMDAHistory();
+  // done for this scenario, save the prevalence values for this replicate
+  if (!_DEBUG)
+    sc.printResults(branch->rep, branch->output, branch->popln);
+  if (stopping)
+    recordHeadlines(s, branch->rep, branch->output, branch->popln);
 
-    } // end of each scenario
-    if (!_DEBUG) {
-      std::cout << "\b\b\b\b";
-      std::cout << std::setw(3) << int(rep * 100 / replicates) << "%";
+  // scenarios that carry on from where this one ends
+  forkChildren(branch, s, false, scenarios, fork);
+}
+
+void Model::forkChildren(std::shared_ptr<ReplicateBranch> branch, int parent,
+                         bool parentContinues, ScenariosList &scenarios,
+                         const Fork &fork) {
+
+  // the scenarios that start from this month of parent. If parent does not
+  // carry on, the first of them takes over its branch
+  for (unsigned t = parent + 1; t < scenarios.getNumScenarios(); t++) {
+    if (scenarios.getParent(t) != parent ||
+        scenarios[t].getStartMonth() != branch->currentMonth)
+      continue;
+
+    if (!parentContinues) {
+      parentContinues = true;
+      fork(branch, t);
+      continue;
     }
-  } // end for each rep
+    // as runReplicate does when a scenario starts from an earlier month
+    std::shared_ptr<ReplicateBranch> child =
+        std::make_shared<ReplicateBranch>(*branch);
+    child->popln.resetToMonth(child->currentMonth);
+    child->vectors.resetToMonth(child->currentMonth);
+    child->output.resetToMonth(child->currentMonth);
+    if (!commonRandomNumbers)
+      child->popln.getStats().set_seed(
+          Statistics::streamSeed(branch->seed, t));
+    fork(child, t);
+  }
+}
 
-  scenarios.closeFiles();
-  // finished
+void Model::runReplicate(int rep, ScenariosList &scenarios, Population &popln,
+                         Vector &vectors, Worm &worms, Output &currentOutput,
+                         const std::vector<unsigned long int> &seeds,
+                         const std::vector<double> &cov_props,
+                         std::vector<double> &k_vals,
+                         std::vector<double> &v_to_h_vals,
+                         std::vector<double> &aImp_vals,
+                         std::vector<double> &wPropMDA, int replicates,
+                         int outputEndgame, int outputEndgameDate,
+                         bool outputNTDMC, int outputNTDMCDate,
+                         int reduceImpViaXml,
+                         const RandomParameters &randParams,
+                         std::string opDir) {
+
+  unsigned long int rseed;
+  double cov_prop;
+  startReplicate(rep, scenarios, popln, vectors, worms, currentOutput, seeds,
+                 cov_props, k_vals, v_to_h_vals, aImp_vals, wPropMDA,
+                 replicates, randParams, rseed, cov_prop);
+
+  // Run each scenario
+  for (unsigned s = 0; s < scenarios.getNumScenarios(); s++) {
+
+    Scenario &sc = scenarios[s];
+
+    if (_DEBUG)
+      std::cout << std::endl
+                << sc.getName() << " starts month " << sc.getStartMonth()
+                << std::endl;
+
+    if (sc.getStartMonth() != currentMonth) {
+
+      // reset to the start of this month
+      currentMonth = sc.getStartMonth();
+      // reset to the start of currentMonth
+      popln.resetToMonth(currentMonth);   // worms and aImp
+      vectors.resetToMonth(currentMonth); // L3
+
+      // delete any results with a month >= to this month
+      currentOutput.resetToMonth(currentMonth); // MDA and prev
+    }
+
+    // evolve, saving any specified months along the way
+    for (int y = 0; y < sc.getNumMonthsToSave(); y++) {
+      evolveAndSave(y, popln, vectors, worms, sc, currentOutput, rep, k_vals,
+                    v_to_h_vals, popln.getUpdateParams(), outputEndgame,
+                    outputEndgameDate, outputNTDMC, outputNTDMCDate,
+                    reduceImpViaXml, opDir, cov_prop);
+    }
+
+    // this scenario's per-replicate csv files are complete
+    sc.closeOutputFiles(rep);
+
+    // done for this scenario, save the prevalence values for this replicate
+    if (!_DEBUG)
+      sc.printResults(rep, currentOutput, popln);
+    if (stopping)
+      recordHeadlines(s, rep, currentOutput, popln);
+
+    if (_DEBUG)
+      popln.printMDAHistory();
+
+  } // end of each scenario
+}
+
+void Model::startReplicate(int rep, ScenariosList &scenarios, Population &popln,
+                           Vector &vectors, Worm &worms, Output &currentOutput,
+                           const std::vector<unsigned long int> &seeds,
+                           const std::vector<double> &cov_props,
+                           std::vector<double> &k_vals,
+                           std::vector<double> &v_to_h_vals,
+                           std::vector<double> &aImp_vals,
+                           std::vector<double> &wPropMDA, int replicates,
+                           const RandomParameters &randParams,
+                           unsigned long int &rseed, double &cov_prop) {
+
+  // random numbers for this replicate come from the population's generator
+  Statistics &stats = popln.getStats();
+
+  // the second of an antithetic pair has the seed of the first. Its
+  // coverage and parameters are its own, as sharing those would make the
+  // pair agree more rather than less
+  int seedRep = rep;
+  if (antitheticPairs) {
+    seedRep = rep - rep % 2;
+    stats.setPairing(rep % 2 ? Statistics::secondOfPair
+                             : Statistics::firstOfPair);
+  } else
+    stats.setPairing(Statistics::unpaired);
+
+  // Read the seed from the seeds vector if it has been generated
+  // othewise we set a random seed
+  if (seeds.size() > 0) {
+    rseed = seeds[seedRep];
+    stats.set_seed(rseed);
+  } else {
+    rseed = std::chrono::system_clock::now().time_since_epoch().count();
+    stats.set_seed(rseed);
+  }
+  popln.setCommonRandomNumbers(commonRandomNumbers, rseed);
+  // Read the value to multiply the MDA's by if this has been supplied
+  // othewise we set this to 1
+  if (cov_props.size() > 0) {
+    cov_prop = cov_props[rep];
+  } else {
+    cov_prop = 1.0;
+  }
+  randParams.getReplicate(rep, k_vals, v_to_h_vals, aImp_vals, wPropMDA);
+  currentMonth = 0;
+  popln.clearSavedMonths();
+  vectors.clearSavedMonths();
+  currentOutput.initialise(); // delete previous replicate
+
+  // functions temporarily altered to allow random value to be passed in
+
+  std::string distType = stats.selectDistribType();
+  // create a new host population with random size, ages and compliance p vals
+  // and bite risk. Generates new value for k and aImp
+  // popln.initHosts(distType, k_vals[rep], aImp_vals[rep]);
+  popln.initHosts(distType, k_vals[0], aImp_vals[0]);
+  // generate vector to host ratio value and reset L3 to initial value
+  // vectors.reset(distType, v_to_h_vals[rep]);
+  vectors.reset(distType, v_to_h_vals[0]);
+
+  // tmp fix to set wPropMDA
+  // worms.reset(wPropMDA[rep]);
+  worms.reset(wPropMDA[0]);
+
+  // save these values for printing later
+  currentOutput.clearRandomValues();
+  // MUST be cvalled i nsame order as saveRandomNames above
+  currentOutput.saveSeedValue(rseed);
+  currentOutput.saveRandomValues(popln.printRandomVariableValues());
+  currentOutput.saveRandomValues(vectors.printRandomVariableValues());
+  currentOutput.saveRandomValues(worms.printRandomVariableValues());
+
+  // baseline prevalence
+  PrevalenceEvent pe = PrevalenceEvent(
+      popln.getMinAgePrev(), scenarios.getExtraMinAge(),
+      scenarios.getExtraMaxAge(),
+      scenarios.getOutputtMethod()); // default age range and method to output
+                                     // at end of burn in
+  // the burn-in can be restored from the cache when the seed is known
+  std::string burnInKey;
+  if (burnInCache && seeds.size() > 0) {
+    std::ostringstream rule;
+    if (equilibriumTolerance > 0)
+      rule << "equilibrium " << std::hexfloat << equilibriumTolerance
+           << " min years " << minBurnInYears;
+    else
+      rule << "fixed";
+    if (stats.getPairing() != Statistics::unpaired)
+      rule << " pair member " << stats.getPairing();
+    burnInKey = burnInCache->key(rseed, popln, vectors, worms, dt, rule.str());
+  }
+  int burnInSteps = burnIn(popln, vectors, worms, currentOutput, &pe,
+                           burnInKey); // should be at least 100 years
+  if (equilibriumTolerance > 0)
+    currentOutput.saveRandomValues({burnInSteps * dt / 12});
+}
+
+void Model::recordHeadlines(int s, int rep, Output &output,
+                            const Population &popln) const {
+
+  int n = output.lastPrevalenceIndex(stoppingYear);
+  if (n < 0) {
+    std::cout << "Error in Model::recordHeadlines. No prevalence output";
+    if (stoppingYear)
+      std::cout << " in " << stoppingYear;
+    std::cout << " to stop replicates on" << std::endl;
+    exit(1);
+  }
+  stopping->add(s, rep, output.printPrevalence(n)->MF,
+                popln.TAS_Pass == neededTASPass);
+}
+
+void Model::writePrecision(ScenariosList &scenarios, int index,
+                           int reps) const {
+
+  // one line per scenario, named as the other result files are
+  std::ostringstream fname;
+  fname << scenarios.getOutputDir() << index << "_" << scenarios.getName()
+        << "_Precision.txt";
+  std::ofstream outfile(fname.str());
+  if (!outfile.is_open()) {
+    std::cout << "Error writing results to file " << fname.str() << std::endl;
+    exit(1);
+  }
+
+  outfile << "Scenario\tReplicates\tMF prevalence year\tMF prevalence"
+             "\tHalf-width\tEPHP\tHalf-width"
+          << std::endl;
+  for (unsigned s = 0; s < scenarios.getNumScenarios(); s++) {
+    ReplicateStopping::estimate mf = stopping->mfPrevalence(s, reps);
+    ReplicateStopping::estimate ephp = stopping->EPHP(s, reps);
+    outfile << scenarios[s].getName() << "\t" << reps << "\t"
+            << (stoppingYear ? std::to_string(stoppingYear) : "last") << "\t"
+            << mf.mean << "\t" << mf.halfWidth << "\t" << ephp.mean << "\t"
+            << ephp.halfWidth << std::endl;
+  }
+
+  std::cout << std::endl
+            << "Stopped after " << reps << " replicates, "
+            << (stopping->precise(reps) ? "within" : "not all within")
+            << " half-width " << stoppingHalfWidth << std::endl;
 }
 
 bool Model::shouldReduceImportationViaPrevalance(
@@ -183,17 +565,28 @@ bool Model::shouldReduceImportationViaPrevalance(
   }
 }
 
-void Model::burnIn(Population &popln, Vector &vectors, const Worm &worms,
-                   Output &currentOutput, PrevalenceEvent *pe) {
+int Model::burnIn(Population &popln, Vector &vectors, const Worm &worms,
+                  Output &currentOutput, PrevalenceEvent *pe,
+                  std::string burnInKey) {
 
   // burn in period. Don't need to worry about drugs
-  // just save final state
+  // just save final state. Returns the number of steps taken
 
   int steps = 12 * std::max(100, popln.getMaxAge()) /
               dt; // one step is 1 * dt months, run for 100 years, Must be at
                   // least maxAge
 
-  for (int i = 0; i < steps; i++) {
+  // if looking for equilibrium, check once a year from minBurnInYears on
+  int stepsPerYear = std::max(1, int(std::round(12 / dt)));
+  int minSteps = 12 * minBurnInYears / dt;
+  Equilibrium equilibrium(equilibriumTolerance);
+
+  // an earlier run may already have done this burn-in
+  int i = 0;
+  bool cached = !burnInKey.empty() &&
+                burnInCache->restore(burnInKey, popln, vectors, i);
+
+  while (!cached && i < steps) {
 
     // updates number of worms in each hosts and increments host age
     popln.evolve(dt, vectors, worms);
@@ -201,16 +594,32 @@ void Model::burnIn(Population &popln, Vector &vectors, const Worm &worms,
     // update larval density in the vector population according to new mf levels
     // in host polution
     vectors.updateL3Density(popln, worms);
+    i++;
+
+    if (equilibriumTolerance > 0 && i % stepsPerYear == 0) {
+      equilibrium.addYear(vectors.getL3Density(),
+                          popln.getMFPrevByAge(0, popln.getMaxAge(), false),
+                          popln.getMeanWormBurden());
+      if (i >= minSteps && equilibrium.reached())
+        break;
+    }
   }
 
-  // these are initial conditions for start of month zero
+  if (!burnInKey.empty() && !cached)
+    burnInCache->save(burnInKey, popln, vectors, i);
+
+  RecordedPrevalence prevalence = popln.getPrevalence(
+      pe); // prev measured before mda done to kill mf in hosts
+
+  // these are initial conditions for start of month zero. Saved after the
+  // prevalence draws, so that scenarios from month zero start from the same
+  // random numbers as the first
   popln.saveCurrentState(0, "burn-in"); // worms and importation rate. Scenario
                                         // name just needed for debugging
   vectors.saveCurrentState(0);          // larval density
 
-  RecordedPrevalence prevalence = popln.getPrevalence(
-      pe); // prev measured before mda done to kill mf in hosts
   currentOutput.saveMonth(-1, popln, pe, prevalence);
+  return i;
 }
 
 void Model::evolveAndSave(int y, Population &popln, Vector &vectors,
@@ -251,15 +660,8 @@ void Model::evolveAndSave(int y, Population &popln, Vector &vectors,
   int changeSensSpec = 0;
   int changeNeverTreat = 0;
   // int maxAge = popln.getMaxAge();
-  int neededTASPass =
-      3; // number of times TAS must be passed to reached WHO target
-         // (https://www.who.int/publications/i/item/9789241501484)
   // int outputTime = floor(currentMonth/12);
   // int outputTime = 0;
-  int LymphodemaTotalWorms = popln.getLymphodemaTotalWorms();
-  int HydroceleTotalWorms = popln.getHydroceleTotalWorms();
-  double LymphodemaShape = popln.getLymphodemaShape();
-  double HydroceleShape = popln.getHydroceleShape();
 
   // Only initalize outputs if we are at the start of a simulation, when y==0
   // (rather than reinitializing for a scenario that has already started)
@@ -308,6 +710,7 @@ void Model::evolveAndSave(int y, Population &popln, Vector &vectors,
 
   for (int t = currentMonth; t < targetMonth; t += dt) {
 
+    popln.startMonth(t);
     paramIndex = t / 12;
     // if we are updating the k and v_to_h params, then do so if the time is
     // right to do so
@@ -325,13 +728,13 @@ void Model::evolveAndSave(int y, Population &popln, Vector &vectors,
     // sequelae prevalence in each age group. If it is earlier than the first
     // year we want to do the endgame output for, then don't do this.
     if ((t % 12 == 0) && (outputEndgame == 1) && (t >= outputEndgameDate)) {
-      sc.writePrevByAge(popln, t, rep, folderName);
+      AgeCensus census;
+      popln.takeAgeCensus(census);
+      sc.writePrevByAge(census, t, rep, folderName);
 
-      sc.writeNumberByAge(popln, t, rep, folderName, "not survey");
-      sc.writeSequelaeByAge(popln, t, LymphodemaTotalWorms, LymphodemaShape,
-                            HydroceleTotalWorms, HydroceleShape, rep,
-                            folderName);
-      popln.getIncidence(sc, t, rep, folderName);
+      sc.writeNumberByAge(census.number, t, rep, folderName, "not survey");
+      sc.writeSequelaeByAge(census, t, rep, folderName);
+      sc.writeIncidence(t, census.incidence, rep, folderName);
       sc.writeSurveyByAge(popln, t, popln.preTAS_Pass, popln.TAS_Pass, rep,
                           folderName);
     }
@@ -356,7 +759,8 @@ void Model::evolveAndSave(int y, Population &popln, Vector &vectors,
 
         int year = (t + 1) / 12 + BASEYEAR - 1;
         sc.writeEmptySurvey(year, maxAge, rep, "PreTAS survey", folderName);
-        sc.writeNumberByAge(popln, t, rep, folderName, "PreTAS survey");
+        sc.writeNumberByAge(popln.getNumbersByAge(), t, rep, folderName,
+                            "PreTAS survey");
       }
       donePreTAS = 0;
 
@@ -364,7 +768,8 @@ void Model::evolveAndSave(int y, Population &popln, Vector &vectors,
 
         int year = (t + 1) / 12 + BASEYEAR - 1;
         sc.writeEmptySurvey(year, maxAge, rep, "TAS survey", folderName);
-        sc.writeNumberByAge(popln, t, rep, folderName, "TAS survey");
+        sc.writeNumberByAge(popln.getNumbersByAge(), t, rep, folderName,
+                            "TAS survey");
       }
       doneTAS = 0;
     }
@@ -402,7 +807,8 @@ void Model::evolveAndSave(int y, Population &popln, Vector &vectors,
       popln.preTAS_Pass = popln.PreTASSurvey(
           sc, outputEndgame, t, outputEndgameDate, rep, folderName);
       if ((outputEndgame == 1) && (t >= outputEndgameDate)) {
-        sc.writeNumberByAge(popln, t, rep, folderName, "PreTAS survey");
+        sc.writeNumberByAge(popln.getNumbersByAge(), t, rep, folderName,
+                            "PreTAS survey");
       }
 
       donePreTAS = 1;
@@ -422,7 +828,8 @@ void Model::evolveAndSave(int y, Population &popln, Vector &vectors,
       int TAS_Pass_ind =
           popln.TASSurvey(sc, t, outputEndgameDate, rep, folderName);
       if ((outputEndgame == 1) && (t >= outputEndgameDate)) {
-        sc.writeNumberByAge(popln, t, rep, folderName, "TAS survey");
+        sc.writeNumberByAge(popln.getNumbersByAge(), t, rep, folderName,
+                            "TAS survey");
       }
       doneTAS = 1;
       popln.TAS_Pass += TAS_Pass_ind;
@@ -680,74 +1087,6 @@ double Model::multiplierForCoverage(int t, double cov_prop,
     return cov_prop;
 }
 
-void Model::ProcessLine(const std::string &line, std::vector<double> &k_vals,
-                        std::vector<double> &v_to_h_vals,
-                        std::vector<double> &aImp_vals,
-                        std::vector<double> &wProp_vals) {
-  std::istringstream iss(line);
-  double value;
-  int arraySize = k_vals.size();
-  int k = 0;
-  for (int j = 1; iss >> value; ++j) {
-
-    if (j % 4 == 1) {
-      if (arraySize > 0) {
-        v_to_h_vals[k] = value;
-      } else {
-        v_to_h_vals.push_back(value);
-      }
-    } else if (j % 4 == 2) {
-      if (arraySize > 0) {
-        k_vals[k] = value;
-      } else {
-        k_vals.push_back(value);
-      }
-    } else if (j % 4 == 3) {
-      if (arraySize > 0) {
-        aImp_vals[k] = value;
-      } else {
-        aImp_vals.push_back(value);
-      }
-    } else if (j % 4 == 0) {
-      if (arraySize > 0) {
-        wProp_vals[k] = value;
-        k++;
-      } else {
-        wProp_vals.push_back(value);
-      }
-    }
-  }
-  if (k != arraySize) {
-    std::cout << " Error" << std::endl;
-    std::cerr << "number of input parameters has changed" << std::endl;
-    // exit(1);
-  }
-}
-
-void Model::getRandomParametersMultiplePerLine(
-    int index, std::vector<double> &k_vals, std::vector<double> &v_to_h_vals,
-    std::vector<double> &aImp_vals, std::vector<double> &wProp_vals,
-    unsigned replicates, std::string fname) {
-
-  // Replace with the desired line number
-
-  std::ifstream file(fname);
-  std::string line;
-
-  if (!file.is_open()) {
-    std::cerr << "Failed to open file: " << fname << std::endl;
-  }
-
-  for (int i = 1; i <= index; ++i) {
-    if (!std::getline(file, line)) {
-      std::cerr << "Error reading line " << index << " from file: " << fname
-                << std::endl;
-    }
-  }
-
-  ProcessLine(line, k_vals, v_to_h_vals, aImp_vals, wProp_vals);
-}
-
 void Model::readSeedsFromFile(std::vector<unsigned long int> &seeds,
                               unsigned replicates, std::string fname) {
   // We retrieve the random seeds from the input seed file. The line on which
@@ -14,7 +14,13 @@
 #include <vector>
 
 #include "Output.hpp"
+#include <functional>
+#include <memory>
 
+class BurnInCache;
+class RandomParameters;
+class ReplicateStopping;
+struct ReplicateBranch;
 class Scenario;
 class ScenariosList;
 class Population;
@@ -31,19 +37,102 @@ public:
                     int outputEndgameDate, bool outputNTDMC,
                     int outputNTDMCDate, int reduceImpViaXml,
                     std::string randParamsfile, std::string RandomSeedFile,
-                    std::string RandomCovPropFile, std::string opDir);
+                    std::string RandomCovPropFile, std::string opDir,
+                    int threads = 1, BurnInCache *burnInCache = NULL);
   bool
   shouldReduceImportationViaPrevalance(int t, int reduceImpViaXml,
                                        int switchImportationReducingMethodTime);
 
+  // stop each burn-in once it is at equilibrium to within tolerance, but not
+  // before minYears. A tolerance of 0 always runs the full burn-in
+  void setEquilibriumBurnIn(double tolerance, int minYears) {
+    equilibriumTolerance = tolerance;
+    minBurnInYears = minYears;
+  }
+
+  // run the scenarios that start from the same month of another scenario at
+  // the same time, each from its own copy of that scenario's state
+  void setForkScenarios(bool fork) { forkScenarios = fork; }
+
+  // start every scenario that branches from a saved month with the random
+  // number generator as it was in that month, so that they share draws
+  void setCommonRandomNumbers(bool common) { commonRandomNumbers = common; }
+
+  // run replicates in antithetic pairs. Replicate 2k+1 has the seed of
+  // replicate 2k and inverts 1 - u for each uniform u that 2k inverts, see
+  // Statistics::setPairing
+  void setAntitheticPairs(bool pairs) { antitheticPairs = pairs; }
+
+  // run replicates in rounds until the 95% confidence interval half-width
+  // of each scenario's mf prevalence in targetYear, and of its chance of
+  // reaching EPHP, is at most halfWidth, or all the replicates have been run.
+  // A targetYear of 0 takes the last year with prevalence output. A
+  // halfWidth of 0 always runs all the replicates
+  void setSequentialStopping(double halfWidth, int targetYear) {
+    stoppingHalfWidth = halfWidth;
+    stoppingYear = targetYear;
+  }
+
+  // print the percentage of replicates done as they finish
+  void setShowProgress(bool show) { showProgress = show; }
+
   double multiplierForCoverage(int t, double cov_prop,
                                int removeCoverageReduction,
                                int removeCoverageReductionTime,
                                int graduallyRemoveCoverageReduction);
 
 protected:
-  void burnIn(Population &popln, Vector &vectors, const Worm &worms,
-              Output &currentOutput, PrevalenceEvent *pe);
+  void runReplicate(int rep, ScenariosList &scenarios, Population &popln,
+                    Vector &vectors, Worm &worms, Output &currentOutput,
+                    const std::vector<unsigned long int> &seeds,
+                    const std::vector<double> &cov_props,
+                    std::vector<double> &k_vals,
+                    std::vector<double> &v_to_h_vals,
+                    std::vector<double> &aImp_vals,
+                    std::vector<double> &wPropMDA, int replicates,
+                    int outputEndgame, int outputEndgameDate, bool outputNTDMC,
+                    int outputNTDMCDate, int reduceImpViaXml,
+                    const RandomParameters &randParams, std::string opDir);
+  // an Output with the names of the random values printed for each replicate
+  Output newOutput(ScenariosList &scenarios, const Population &popln,
+                   const Vector &vectors, const Worm &worms) const;
+  void runForkedScenarios(ScenariosList &scenarios, const Population &popln,
+                          const Vector &vectors, const Worm &worms,
+                          int replicates,
+                          const std::vector<unsigned long int> &seeds,
+                          const std::vector<double> &cov_props, int firstRep,
+                          int lastRep, int outputEndgame, int outputEndgameDate,
+                          bool outputNTDMC, int outputNTDMCDate,
+                          int reduceImpViaXml,
+                          const RandomParameters &randParams,
+                          std::string opDir, int threads);
+  void startReplicate(int rep, ScenariosList &scenarios, Population &popln,
+                      Vector &vectors, Worm &worms, Output &currentOutput,
+                      const std::vector<unsigned long int> &seeds,
+                      const std::vector<double> &cov_props,
+                      std::vector<double> &k_vals,
+                      std::vector<double> &v_to_h_vals,
+                      std::vector<double> &aImp_vals,
+                      std::vector<double> &wPropMDA, int replicates,
+                      const RandomParameters &randParams,
+                      unsigned long int &rseed, double &cov_prop);
+
+  // hands a branch to a worker to run the given scenario from
+  typedef std::function<void(std::shared_ptr<ReplicateBranch>, int)> Fork;
+  void runBranch(std::shared_ptr<ReplicateBranch> branch, int s,
+                 ScenariosList &scenarios, const Fork &fork, int outputEndgame,
+                 int outputEndgameDate, bool outputNTDMC, int outputNTDMCDate,
+                 int reduceImpViaXml, std::string opDir);
+  void forkChildren(std::shared_ptr<ReplicateBranch> branch, int parent,
+                    bool parentContinues, ScenariosList &scenarios,
+                    const Fork &fork);
+  // hands the headline values of scenario s of a replicate to stopping
+  void recordHeadlines(int s, int rep, Output &output,
+                       const Population &popln) const;
+  void writePrecision(ScenariosList &scenarios, int index, int reps) const;
+  int burnIn(Population &popln, Vector &vectors, const Worm &worms,
+             Output &currentOutput, PrevalenceEvent *pe,
+             std::string burnInKey = "");
   void evolveAndSave(int y, Population &popln, Vector &vectors, Worm &worms,
                      Scenario &sc, Output &currentOutput, int rep,
                      std::vector<double> &k_vals,
@@ -56,21 +145,27 @@ protected:
                            std::vector<double> &aImp_vals,
                            std::vector<double> &wPropMDA, unsigned replicates,
                            std::string fname);
-  void getRandomParametersMultiplePerLine(
-      int index, std::vector<double> &k_vals, std::vector<double> &v_to_h_vals,
-      std::vector<double> &aImp_vals, std::vector<double> &wProp_vals,
-      unsigned replicates, std::string fname);
   void readSeedsFromFile(std::vector<unsigned long int> &seeds,
                          unsigned replicates, std::string fname);
   void readCovPropFromFile(std::vector<double> &cov_props, unsigned replicates,
                            std::string fname);
-  void ProcessLine(const std::string &line, std::vector<double> &k_vals,
-                   std::vector<double> &v_to_h_vals,
-                   std::vector<double> &aImp_vals,
-                   std::vector<double> &wProp_vals);
 
   int currentMonth;
   double dt;
+  BurnInCache *burnInCache = NULL; // saved burn-ins, if any
+  double equilibriumTolerance = 0.0;
+  int minBurnInYears = 0;
+  bool forkScenarios = false;
+  bool commonRandomNumbers = false;
+  bool antitheticPairs = false;
+  bool showProgress = true;
+  double stoppingHalfWidth = 0.0;
+  int stoppingYear = 0;
+  ReplicateStopping *stopping = NULL; // while running in rounds
+  static const int stoppingRound = 20; // replicates run between checks
+  // number of times TAS must be passed to reached WHO target
+  // (https://www.who.int/publications/i/item/9789241501484)
+  static const int neededTASPass = 3;
   std::vector<std::string> printSeedName() const;
 };
 
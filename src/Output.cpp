@@ -208,6 +208,15 @@ RecordedPrevalence *Output::printPrevalence(int n) {
   // but prevaluence may not be needed if just mda applied
 }
 
+int Output::lastPrevalenceIndex(int year) const {
+
+  for (int n = int(months.size()) - 1; n >= 0; n--)
+    if (months[n].prevalenceNeeded && months[n].month >= 0 &&
+        (year == 0 || months[n].month / 12 + baseYear == year))
+      return n;
+  return -1;
+}
+
 std::string Output::getMinAgeForTreatment(int n) const {
 
   if (unsigned(n) >= months.size()) {
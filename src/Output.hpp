@@ -82,6 +82,9 @@ public:
   std::string printMDASysComp(int n) const;
   std::string printMDAType(int n) const;
   RecordedPrevalence *printPrevalence(int n);
+  // the last month of year with prevalence recorded, or the last of all if
+  // year is 0. -1 if there is none
+  int lastPrevalenceIndex(int year = 0) const;
   int getSize() const { return int(months.size()); };
 
   void clearRandomValues();
@@ -7,7 +7,10 @@
 //
 
 #include "Population.hpp"
+#include "AgeCensus.hpp"
 #include "BedNetEvent.hpp"
+#include "CorrelatedNormal.hpp"
+#include "LarvalUptake.hpp"
 #include "MDAEvent.hpp"
 #include "PrevalenceEvent.hpp"
 #include "Scenario.hpp"
@@ -15,6 +18,7 @@
 #include "tinyxml.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <ios>
 #include <iostream>
@@ -23,8 +27,6 @@
 
 extern bool _DEBUG;
 
-extern Statistics stats;
-
 Population::Population(TiXmlElement *xmlParameters) {
 
   neverTreatedChangeTime = 10000;
@@ -149,6 +151,10 @@ Population::Population(TiXmlElement *xmlParameters) {
       removeCoverageReductionTime = value;
     } else if (name == "graduallyRemoveCoverageReduction") {
       graduallyRemoveCoverageReduction = value;
+    } else if (name == "bedNetsRedrawnMonthly") {
+      bedNetsRedrawnMonthly = (value != 0);
+  } else if (name == "hostEventsDrawnMonthly") {
+    hostEventsDrawnMonthly = (value != 0);
     } else
       std::cout << "Unknown parameter " << name << " in Host parameter list."
                 << std::endl;
@@ -215,7 +221,7 @@ void Population::loadPopulationSize(const std::string popfile) {
   infile.clear();
   infile.seekg(0, std::ios::beg);
 
-  popSize = new int[--numLines]; //-1 as header line
+  popSize.resize(--numLines);    //-1 as header line
   std::vector<double> popWeight; // assumption that col2 in file will sum to 1.0
   popWeight.reserve(numLines);
 
@@ -230,16 +236,20 @@ void Population::loadPopulationSize(const std::string popfile) {
 
   infile.close();
 
-  if (*std::max_element(popSize, popSize + numLines) > MAX_POP) {
+  if (*std::min_element(popSize.begin(), popSize.end()) < 1) {
     std::cout << "Error in Population::loadPopulationSize. The population size "
-                 "cannot exceed "
-              << MAX_POP << std::endl;
+                 "must be at least 1"
+              << std::endl;
     exit(1);
   }
 
+  // reserve room for the largest population so that changing size between
+  // replicates does not reallocate the host columns
+  hosts.reserve(*std::max_element(popSize.begin(), popSize.end()));
+
   // set up discrete sampler
   populationDistribution =
-      new std::discrete_distribution<int>(popWeight.begin(), popWeight.end());
+      std::discrete_distribution<int>(popWeight.begin(), popWeight.end());
 
   // seed random generator
   randgen.seed(
@@ -250,7 +260,7 @@ double Population::selectPopSizeFromDistribution() {
 
   // use distribution defined above to get a population size
 
-  unsigned choice = (*populationDistribution)(randgen);
+  unsigned choice = populationDistribution(randgen);
   // this a number in range 0 to numLines-1
   return popSize[choice];
 }
@@ -265,11 +275,11 @@ void Population::initPTreat(double cov, double rho) {
     double alpha = cov * (1 - rho) / rho;
     double beta = (1 - cov) * (1 - rho) / rho;
     for (int i = 0; i < size; i++) {
-      host_pop[i].initialisePTreat(alpha, beta);
+      Host(hosts, i).initialisePTreat(alpha, beta, stats);
     }
   } else {
     for (int i = 0; i < size; i++) {
-      host_pop[i].pTreat = cov;
+      hosts.pTreat[i] = cov;
     }
   }
 }
@@ -288,13 +298,13 @@ void Population::editPTreat(double cov, double rho) {
     double alpha = cov * (1 - rho) / rho;
     double beta = (1 - cov) * (1 - rho) / rho;
     // create array to hold these probabilities
-    double pTreats[size];
+    std::vector<double> pTreats(size);
     // draw probabilities from the beta distribution
     for (int i = 0; i < size; i++) {
       pTreats[i] = stats.beta_dist(alpha, beta);
     }
     // sort these values so that they are in ascending order
-    std::sort(pTreats, pTreats + size);
+    std::sort(pTreats.begin(), pTreats.end());
 
     // We want to know the rank of each of the host populations pTreat so that
     // we can maintain the order of their probability of treatment under new
@@ -302,34 +312,34 @@ void Population::editPTreat(double cov, double rho) {
     // appropriate individual
 
     // Create an array of indices
-    int indices[size];
+    std::vector<int> indices(size);
 
     for (int i = 0; i < size; i++) {
       indices[i] = i;
     }
     // store the current value of the pTreat in an array
-    double oldPTreat[size];
+    std::vector<double> oldPTreat(size);
     // std::cout << "OLDPtreat" << std::endl;
     for (int i = 0; i < size; i++) {
-      oldPTreat[i] = host_pop[i].pTreat;
+      oldPTreat[i] = hosts.pTreat[i];
     }
 
     // Sort the indices array based on the values in oldPTreat
-    std::sort(indices, indices + size, CompareArray(oldPTreat));
+    std::sort(indices.begin(), indices.end(), CompareArray(oldPTreat.data()));
 
     // now assign the value from the newly drawn beta distribution stored in
-    // pTreats to the appropriate place in the host_pop based on the rank of the
+    // pTreats to the appropriate place in the hosts based on the rank of the
     // current values there which are stored in the oldPTreat array. This works
     // as the entries in the pTreats array are already in ascending order.
     // std::cout << "NEWPtreat" << std::endl;
     // Assign the newly drawn treatment probabilities to the appropriate
     // individuals
     for (int i = 0; i < size; i++) {
-      host_pop[indices[i]].pTreat = pTreats[i];
+      hosts.pTreat[indices[i]] = pTreats[i];
     }
   } else {
     for (int i = 0; i < size; i++) {
-      host_pop[i].pTreat = cov;
+      hosts.pTreat[i] = cov;
     }
   }
 }
@@ -341,14 +351,14 @@ void Population::checkForZeroPTreat(double cov, double rho) {
     double alpha = cov * (1 - rho) / rho;
     double beta = (1 - cov) * (1 - rho) / rho;
     for (int i = 0; i < size; i++) {
-      if (host_pop[i].pTreat == 0) {
-        host_pop[i].pTreat = stats.beta_dist(alpha, beta);
+      if (hosts.pTreat[i] == 0) {
+        hosts.pTreat[i] = stats.beta_dist(alpha, beta);
       }
     }
   } else {
     for (int i = 0; i < size; i++) {
-      if (host_pop[i].pTreat == 0) {
-        host_pop[i].pTreat = cov;
+      if (hosts.pTreat[i] == 0) {
+        hosts.pTreat[i] = cov;
       }
     }
   }
@@ -369,6 +379,8 @@ void Population::initHosts(std::string distType, double k_val,
   // generate a new population size and reset all members at the start of a new
   // replicate
   size = selectPopSizeFromDistribution();
+  hosts.resize(size);
+  mfPositive.changed();
   TotalBiteRisk = 0.0;
 
   // new random value for k, shape of gamma distrib
@@ -390,10 +402,15 @@ void Population::initHosts(std::string distType, double k_val,
 
   for (int i = 0; i < size;
        i++) // TotalBiteRisk sums bites per month for whole popln
-    host_pop[i].initialise(
+    Host(hosts, i).initialise(
         tau, maxAge, k, &TotalBiteRisk, HydroceleShape, LymphodemaShape,
-        neverTreated); // sets worm count to 0 and treated/bednet to 0. Sets
-                       // random age and bite risk
+        neverTreated, stats); // sets worm count to 0 and treated/bednet to 0.
+                              // Sets random age and bite risk
+  clock = {0.0, 0.0};
+  if (!hostEventsDrawnMonthly)
+    for (int i = 0; i < size; i++)
+      Host(hosts, i).scheduleEvents(clock, stats);
+  aggregates.recount(hosts);
 
   u0CompBednets =
       std::numeric_limits<double>::max(); // initial value indicates first time
@@ -405,6 +422,7 @@ void Population::initHosts(std::string distType, double k_val,
   sysCompBednets = 0.99;
 
   bedNetCov = 0.0;
+  netsDrawn = false;
   aImp_factor = 1.0;
   mdaCoverage = 0.0;
   numPreTASSurveys = 0;
@@ -425,48 +443,50 @@ void Population::updateKVal(double k_val) {
   k = k_val;
   TotalBiteRisk = 0.0;
   // create array to hold these probabilities
-  double biteRisk[size];
+  std::vector<double> biteRisk(size);
   // draw probabilities from the beta distribution
   for (int i = 0; i < size; i++) {
     biteRisk[i] = stats.gamma_dist(k);
     TotalBiteRisk += biteRisk[i];
   }
   // sort these values so that they are in ascending order
-  std::sort(biteRisk, biteRisk + size);
+  std::sort(biteRisk.begin(), biteRisk.end());
   // We want to know the rank of each of the host populations pTreat so that we
   // can maintain the order of their probability of treatment under new coverage
   // and rho values by assigning the newly drawn probabilities to the
   // appropriate individual
 
   // Create an array of indices
-  int indices[size];
+  std::vector<int> indices(size);
 
   for (int i = 0; i < size; i++) {
     indices[i] = i;
   }
   // store the current value of the pTreat in an array
-  double oldbiteRisk[size];
+  std::vector<double> oldbiteRisk(size);
   for (int i = 0; i < size; i++) {
-    oldbiteRisk[i] = host_pop[i].biteRisk;
+    oldbiteRisk[i] = hosts.biteRisk[i];
   }
 
   // Sort the indices array based on the values in oldPTreat
-  std::sort(indices, indices + size, CompareArray(oldbiteRisk));
+  std::sort(indices.begin(), indices.end(), CompareArray(oldbiteRisk.data()));
 
   // now assign the value from the newly drawn beta distribution stored in
-  // pTreats to the appropriate place in the host_pop based on the rank of the
+  // pTreats to the appropriate place in the hosts based on the rank of the
   // current values there which are stored in the oldPTreat array. This works as
   // the entries in the pTreats array are already in ascending order.
 
   // Assign the newly drawn treatment probabilities to the appropriate
   // individuals
   for (int i = 0; i < size; i++) {
-    host_pop[indices[i]].biteRisk = biteRisk[i];
+    hosts.biteRisk[indices[i]] = biteRisk[i];
   }
 }
 
-RecordedPrevalence
-Population::getPrevalence(PrevalenceEvent *outputPrev) const {
+RecordedPrevalence Population::getPrevalence(PrevalenceEvent *outputPrev) {
+
+  // not const, as sampling whether hosts are mf positive advances the
+  // population's random number stream
 
   int numHosts = 0;
   int numHostsExtra = 0;
@@ -496,38 +516,33 @@ Population::getPrevalence(PrevalenceEvent *outputPrev) const {
 
   for (int i = 0; i < size; i++) {
 
-    bool infectedMF =
-        needsMF &&
-        (stats.uniform_dist() <
-         (1 - exp(-1 * host_pop[i].M))); // depends on how many mf present
-    bool infectedIC = needsIC && (host_pop[i].WF > 0 ||
-                                  host_pop[i].WM > 0); // at least 1 adult worm
+    double infectedMF = needsMF ? mfTestPositive(i) : 0;
+    bool infectedIC = needsIC && (hosts.WF[i] > 0 ||
+                                  hosts.WM[i] > 0); // at least 1 adult worm
 
-    if (host_pop[i].age >= minAgeinMonths) {
+    if (hosts.age[i] >= minAgeinMonths) {
       numHosts++;
-      if (infectedMF)
-        prevalence.MF++;
+      prevalence.MF += infectedMF;
       if (infectedIC)
         prevalence.IC++;
       if (needsWC)
-        prevalence.WC += (host_pop[i].WF + host_pop[i].WM);
+        prevalence.WC += (hosts.WF[i] + hosts.WM[i]);
     }
 
     if (requiresExtra) {
 
-      if ((host_pop[i].age >= minAgeInMonthsExtra) &&
-          (host_pop[i].age <= maxAgeInMonthsExtra)) {
+      if ((hosts.age[i] >= minAgeInMonthsExtra) &&
+          (hosts.age[i] <= maxAgeInMonthsExtra)) {
         numHostsExtra++;
-        if (infectedMF)
-          prevalence.MFRestrictedAge++;
+        prevalence.MFRestrictedAge += infectedMF;
         if (infectedIC)
           prevalence.ICRestrictedAge++;
         if (needsWC)
-          prevalence.WCRestrictedAge += (host_pop[i].WF + host_pop[i].WM);
+          prevalence.WCRestrictedAge += (hosts.WF[i] + hosts.WM[i]);
       }
     }
 
-    prevalence.saveAge(host_pop[i].age);
+    prevalence.saveAge(hosts.age[i]);
   }
 
   if (numHosts) {
@@ -576,6 +591,36 @@ int Population::TASSurvey(Scenario &sc, int t, int outputEndgameDate, int rep,
   return TAS_Pass;
 }
 
+// Partial Fisher-Yates shuffle of the host indices, drawing the next host
+// only when it is needed. The swaps are undone when it goes out of scope,
+// leaving the indices in order for the next survey without refilling them
+class SurveyOrder {
+
+public:
+  SurveyOrder(std::vector<int> &indices, int size) : indices(indices) {
+    if ((int)indices.size() != size) {
+      indices.resize(size);
+      std::iota(indices.begin(), indices.end(), 0);
+    }
+  }
+  ~SurveyOrder() {
+    for (int k = (int)swapped.size() - 1; k >= 0; k--)
+      std::swap(indices[k], indices[swapped[k]]);
+  }
+
+  int next(Statistics &stats) {
+    int k = swapped.size();
+    int j = k + stats.uniform_int(indices.size() - k);
+    std::swap(indices[k], indices[j]);
+    swapped.push_back(j);
+    return indices[k];
+  }
+
+private:
+  std::vector<int> &indices;
+  std::vector<int> swapped;
+};
+
 double Population::getMFPrev(Scenario &sc, int forPreTass, int t,
                              int outputEndgameDate, int rep, int sampleSize,
                              std::string folderName) {
@@ -592,30 +637,36 @@ double Population::getMFPrev(Scenario &sc, int forPreTass, int t,
   for (int i = 0; i < maxAge; ++i) {
     numSurvey[i] = 0; // initialization
   }
-  std::vector<int> people_indices(size);
-  std::iota(people_indices.begin(), people_indices.end(),
-            0); // fill indices with 0, 1, ..., size-1
-  stats.shuffle_indices(people_indices);
 
-  for (int person_index : people_indices) {
+  // hosts are surveyed in a random order, drawn one at a time as needed. If
+  // the sample would take every eligible host anyway, they are taken in turn
+  int eligible = 0;
+  for (int i = 0; i < size; i++)
+    if ((hosts.age[i] >= minAgeMonths) && (hosts.age[i] <= maxAgeMonths))
+      eligible++;
+  bool randomOrder = (sampleSize < eligible);
+  SurveyOrder order(surveyOrder, size);
+
+  for (int k = 0; k < size; k++) {
     // Stop when we have surveyed the number of people specified by sampleSize,
     // as this is the number of people we want to sample
     if (numHostsSampled >= sampleSize)
       break;
 
-    if ((host_pop[person_index].age >= minAgeMonths) &&
-        (host_pop[person_index].age <= maxAgeMonths)) {
+    int person_index = randomOrder ? order.next(stats) : k;
+
+    if ((hosts.age[person_index] >= minAgeMonths) &&
+        (hosts.age[person_index] <= maxAgeMonths)) {
       // we want to track the number of people of each age who are surveyed so
       // that we can output this later if this is done for a pre TAS survey
-      float flooredAge = std::floor(host_pop[person_index].age / 12);
+      float flooredAge = std::floor(hosts.age[person_index] / 12);
       int flooredAgeInt = std::min(static_cast<int>(flooredAge), maxAge - 1);
       numSurvey[flooredAgeInt] += 1;
 
       bool infectedMF =
           (stats.uniform_dist() <
-           (1 - exp(-1 * host_pop[person_index]
-                             .M))); // probability of being measured as infected
-                                    // depends on how many mf present
+           mfPositive(hosts, person_index)); // probability of being measured
+                                             // as infected
       numHostsSampled++;            // increment number of hosts sampled by 1
       if (infectedMF)
         MFpos++; // if mf positive, increment MFpos by 1
@@ -638,35 +689,6 @@ double Population::getMFPrev(Scenario &sc, int forPreTass, int t,
   }
 }
 
-void Population::getIncidence(Scenario &sc, int t, int rep,
-                              std::string folderName) {
-  // get incidence
-
-  int incidence[maxAge];
-  for (int i = 0; i < maxAge; ++i) {
-    incidence[i] = 0; // initialization
-  }
-
-  for (int i = 0; i < size; i++) {
-    float flooredAge = std::floor(host_pop[i].age / 12);
-    int flooredAgeInt = std::min(static_cast<int>(flooredAge), maxAge - 1);
-    bool infectedMF =
-        (stats.uniform_dist() <
-         (1 - exp(-1 * host_pop[i].M))); // depends on how many mf present
-
-    if (infectedMF) {
-
-      if (host_pop[i].previouslyInfected == 0) {
-        incidence[flooredAgeInt] += 1; // if mf positive, increment MFpos by 1
-        host_pop[i].previouslyInfected = 1;
-      }
-    } else {
-      host_pop[i].previouslyInfected = 0;
-    }
-  }
-  sc.writeIncidence(t, incidence, maxAge, rep, folderName);
-}
-
 double Population::getMFPrevByAge(double ageStart, double ageEnd, bool sample) {
   // get mf prevalence
 
@@ -674,20 +696,18 @@ double Population::getMFPrevByAge(double ageStart, double ageEnd, bool sample) {
   double numHostsSampled = 0; // total number of hosts
   int minAgeMonths = ageStart * 12;
   int maxAgeMonths = ageEnd * 12;
-  bool infectedMF;
+  double infectedMF;
   for (int i = 0; i < size; i++) {
-    if ((host_pop[i].age >= minAgeMonths) && (host_pop[i].age < maxAgeMonths)) {
+    if ((hosts.age[i] >= minAgeMonths) && (hosts.age[i] < maxAgeMonths)) {
       if (sample) {
-        infectedMF =
-            (stats.uniform_dist() <
-             (1 - exp(-1 * host_pop[i].M))); // depends on how many mf present
+        infectedMF = mfTestPositive(i);
       } else {
-        infectedMF = host_pop[i].M > 0; // as true prev, we just report if there
-                                        // are any mf present at all
+        infectedMF = (hosts.M[i] > 0) ? 1 : 0; // as true prev, we just report
+                                               // if there are any mf present
+                                               // at all
       }
       numHostsSampled++; // increment number of hosts by 1
-      if (infectedMF)
-        MFpos++; // if mf positive, increment MFpos by 1
+      MFpos += infectedMF; // if mf positive, increment MFpos by 1
     }
   }
   if (numHostsSampled > 0) {
@@ -698,89 +718,24 @@ double Population::getMFPrevByAge(double ageStart, double ageEnd, bool sample) {
   }
 }
 
-double Population::getNumberByAge(double ageStart, double ageEnd) {
-  // get mf prevalence
-
-  double numHosts = 0; // total number of hosts
-  int minAgeMonths = ageStart * 12;
-  int maxAgeMonths = ageEnd * 12;
-  for (int i = 0; i < size; i++) {
-    if ((host_pop[i].age >= minAgeMonths) && (host_pop[i].age < maxAgeMonths)) {
-      numHosts++; // increment number of hosts by 1
-    }
-  }
+void Population::takeAgeCensus(AgeCensus &census) {
 
-  return numHosts;
+  // all the per age-year output for the year, in one walk over the hosts
+  census.take(hosts, size, maxAge, HydroceleTotalWorms, LymphodemaTotalWorms,
+              stats, mfPositive, expectedPrevalence);
 }
 
-double Population::HydroceleTestByAge(int ageStart, int ageEnd,
-                                      int HydroceleTotalWorms,
-                                      double HydroceleShape) {
-  // get proportion of people in a given age bracket who are hydrocele positive
-
-  double HydroPos = 0;        // number of people mf positive
-  double numHostsSampled = 0; // total number of hosts
-  int minAgeMonths = ageStart * 12;
-  int maxAgeMonths = ageEnd * 12;
-  double mult = 0;
-  for (int i = 0; i < size; i++) {
-
-    if ((host_pop[i].age >= minAgeMonths) &&
-        (host_pop[i].age <= maxAgeMonths) &&
-        (host_pop[i].sex == 0)) { // only men can get hydrocele
-      mult =
-          host_pop[i].hydroMult; // draw random number from gamma distribution
-                                 // with appropriate shape which gives
-                                 // individual susceptibility to sequelae
-      bool Hydro = ((mult * host_pop[i].totalWorms) >
-                    HydroceleTotalWorms); // individual susceptibility * total
-                                          // worms > threshold or not
-      numHostsSampled++;                  // increment number of hosts by 1
-      if (Hydro)
-        HydroPos++; // if hydrocele positive, increment hydrocelePos by 1
-    }
-  }
-  if (numHostsSampled > 0) {
-    return HydroPos /
-           numHostsSampled; // convert to prevalence of hydrocele positive hosts
-  } else {
-    return 0.0;
-  }
+double Population::mfTestPositive(int i) {
+  if (expectedPrevalence)
+    return mfPositive(hosts, i);
+  return (stats.uniform_dist() < mfPositive(hosts, i)) ? 1 : 0;
 }
 
-double Population::LymphodemaTestByAge(int ageStart, int ageEnd,
-                                       int LymphodemaTotalWorms,
-                                       double LymphodemaShape) {
-  // get proportion of people in a given age bracket who are lymphodema positive
+std::vector<int> Population::getNumbersByAge() const {
 
-  double LymphodemaPos = 0;   // number of people mf positive
-  double numHostsSampled = 0; // total number of hosts
-  int minAgeMonths = ageStart * 12;
-  int maxAgeMonths = ageEnd * 12;
-  double mult = 0;
-  for (int i = 0; i < size; i++) {
-
-    if ((host_pop[i].age >= minAgeMonths) &&
-        (host_pop[i].age <= maxAgeMonths)) { // only men can get hydrocele
-      mult =
-          host_pop[i].lymphoMult; // draw random number from gamma distribution
-                                  // with appropriate shape which gives
-                                  // individual susceptibility to sequelae
-      bool Lymphodema =
-          ((mult * host_pop[i].totalWorms) >
-           LymphodemaTotalWorms); // individual susceptibility * total worms >
-                                  // threshold or not
-      numHostsSampled++;          // increment number of hosts by 1
-      if (Lymphodema)
-        LymphodemaPos++; // if lymphodema positive, increment LymphodemaPos by 1
-    }
-  }
-  if (numHostsSampled > 0) {
-    return LymphodemaPos /
-           numHostsSampled; // convert to prevalence of hydrocele positive hosts
-  } else {
-    return 0.0;
-  }
+  AgeCensus census;
+  census.count(hosts, size, maxAge);
+  return census.number;
 }
 
 bool Population::test_for_infection(bool is_infected, float ICsensitivity,
@@ -807,9 +762,9 @@ double Population::getICPrev(Scenario &sc, int t, int outputEndgameDate,
     numSurvey[i] = 0;
   }
   for (int i = 0; i < size; i++) {
-    if ((host_pop[i].age < maxAgeMonths) && (host_pop[i].age >= minAgeMonths)) {
-      bool is_infected = (host_pop[i].WF + host_pop[i].WM) > 0;
-      float flooredAge = std::floor(host_pop[i].age / 12);
+    if ((hosts.age[i] < maxAgeMonths) && (hosts.age[i] >= minAgeMonths)) {
+      bool is_infected = (hosts.WF[i] + hosts.WM[i]) > 0;
+      float flooredAge = std::floor(hosts.age[i] / 12);
       int flooredAgeInt = std::min(static_cast<int>(flooredAge), maxAge - 1);
       numSurvey[flooredAgeInt] += 1;
       bool infectedIC =
@@ -844,21 +799,23 @@ double Population::getICPrevForOutput(bool sample) {
   double numHostsSampled = 0; // total number of hosts
   int maxAgeMonths = maxAgeIC * 12;
   int minAgeMonths = minAgeIC * 12;
-  bool infectedIC;
+  double infectedIC;
 
   for (int i = 0; i < size; i++) {
-    if ((host_pop[i].age < maxAgeMonths) && (host_pop[i].age >= minAgeMonths)) {
-      bool is_infected = (host_pop[i].WF + host_pop[i].WM) > 0;
+    if ((hosts.age[i] < maxAgeMonths) && (hosts.age[i] >= minAgeMonths)) {
+      bool is_infected = (hosts.WF[i] + hosts.WM[i]) > 0;
 
-      if (sample) {
+      if (sample && expectedPrevalence) {
+        // chance that the test is positive
+        infectedIC = is_infected ? ICsensitivity : 1 - ICspecificity;
+      } else if (sample) {
         infectedIC =
             test_for_infection(is_infected, ICsensitivity, ICspecificity);
       } else {
         infectedIC = is_infected;
       }
       numHostsSampled++; // increment number of hosts by 1
-      if (infectedIC)
-        ICpos++; // if mf positive, increment MFpos by 1
+      ICpos += infectedIC; // if mf positive, increment MFpos by 1
     }
   }
   if (numHostsSampled > 0) {
@@ -877,27 +834,29 @@ Population::getLarvalUptakebyVector(double r1, double kappas1,
   // each host return total uptake for whole population weighted according to
   // each hosts's bite risk
 
-  double mf = 0.0;
-  double uptake;
-  double TotalBiteRisk = 0;
-  for (int i = 0; i < size; i++) {
-
-    uptake = (1 - exp(-r1 * host_pop[i].M / kappas1));
-    if (species == Vector::Anopheles)
-      uptake *= uptake;
-    mf += host_pop[i].biteRisk * kappas1 * uptake;
-    TotalBiteRisk += host_pop[i].biteRisk;
-  }
-  return mf / TotalBiteRisk;
+  return larvalUptake(hosts.M.data(), hosts.biteRisk.data(), size, r1, kappas1,
+                      species == Vector::Anopheles);
 }
 
 void Population::evolve(double dt, const Vector &vectors, const Worm &worms) {
 
-  // advance one time step
+  // advance one time step. Unless nets are redrawn every month, a newborn
+  // gets a net straight away, as everyone did at the last bed net event
+  bool netsAtBirth = netsDrawn && !bedNetsRedrawnMonthly && netsCoverage > 0;
+  clock.deaths += tau * dt;
+  clock.imports += aImp * dt;
+  const eventClock *due = hostEventsDrawnMonthly ? NULL : &clock;
   for (int i = 0; i < size; i++) {
-    host_pop[i].react(dt, tau, maxAge, aImp, vectors, worms, HydroceleShape,
-                      LymphodemaShape, neverTreated);
+    aggregates.remove(hosts, i);
+    Host(hosts, i).react(dt, tau, maxAge, aImp, vectors, worms, HydroceleShape,
+                      LymphodemaShape, neverTreated, stats, due);
+    if (netsAtBirth && hosts.age[i] == 0) // born this step
+      hosts.bedNet[i] = drawBedNet(i);
+    aggregates.add(hosts, i);
   }
+  mfPositive.changed();
+  if (_DEBUG)
+    aggregates.check(hosts, "Population::evolve");
 }
 
 int Population::getSampleSize() const { return sampleSize; }
@@ -919,9 +878,9 @@ double Population::getNeverTreat() { return neverTreated; }
 void Population::changeNeverTreat() {
   neverTreated = neverTreatedChange;
   for (int i = 0; i < size; i++) {
-    if (host_pop[i].neverTreat == 1) {
+    if (hosts.neverTreat[i] == 1) {
       if (stats.uniform_dist() > (neverTreatedChange / neverTreatedOriginal)) {
-        host_pop[i].neverTreat = 0;
+        hosts.neverTreat[i] = 0;
       }
     }
   }
@@ -949,14 +908,17 @@ void Population::saveCurrentState(int month, std::string sname) {
   savedMonth currentState;
 
   currentState.scenario = sname; // debugging only
-  currentState.data.resize(size);
 
-  for (int i = 0; i < size; i++)
-    currentState.data[i] =
-        host_pop[i]; // overloaded operator extracts data members to struct
+  // only the parts that changed since the last saved month are copied
+  currentState.hosts = HostSnapshot(
+      hosts, size, savedMonths.empty() ? NULL : &savedMonths.back().hosts,
+      commonRandomNumbers);
+  if (commonRandomNumbers)
+    currentState.randomState = stats.getState();
 
   currentState.month = month;
 
+  currentState.clock = clock;
   currentState.aImp = aImp;
   currentState.sysCompMDA = sysCompMDA;
   currentState.sysCompBednets = sysCompBednets;
@@ -973,25 +935,47 @@ void Population::saveCurrentState(int month, std::string sname) {
   currentState.TASSurveyTime = TASSurveyTime;
   currentState.preTAS_Pass = preTAS_Pass;
   currentState.TAS_Pass = TAS_Pass;
+  currentState.time_TAS_Passes = time_TAS_Passes;
+  currentState.ICsensitivity = ICsensitivity;
+  currentState.ICspecificity = ICspecificity;
   currentState.prevCov = prevCov;
   currentState.prevRho = prevRho;
   savedMonths.push_back(currentState);
 }
 
+void Population::setCommonRandomNumbers(bool common, unsigned long int seed) {
+  commonRandomNumbers = common;
+  monthStreamSeed = seed;
+}
+
+void Population::startMonth(int t) {
+  if (commonRandomNumbers)
+    stats.set_seed(Statistics::streamSeed(monthStreamSeed, t));
+}
+
 void Population::resetToMonth(int month) {
 
   // Will always discard any months coming after the one required
 
   while (savedMonths.size()) {
 
-    savedMonth lastMonth = savedMonths.back();
+    const savedMonth &lastMonth = savedMonths.back();
 
     if (lastMonth.month == month) {
 
       // restore host state and importation rate
-      for (int i = 0; i < size; i++)
-        host_pop[i].restore(lastMonth.data[i]);
+      lastMonth.hosts.restore(hosts);
+      mfPositive.changed();
+      aggregates.recount(hosts);
+      netsDrawn = false; // nets aren't always saved, so draw them again
+      if (commonRandomNumbers) {
+        stats.setState(lastMonth.randomState);
+        time_TAS_Passes = lastMonth.time_TAS_Passes;
+        ICsensitivity = lastMonth.ICsensitivity;
+        ICspecificity = lastMonth.ICspecificity;
+      }
 
+      clock = lastMonth.clock;
       aImp = lastMonth.aImp;
       sysCompMDA = lastMonth.sysCompMDA;
       sysCompBednets = lastMonth.sysCompBednets;
@@ -1038,6 +1022,13 @@ void Population::updateBedNetCoverage(BedNetEvent *bn) {
   // This function affects host.uCompMDA via call to setU!!!! if sigmaMDA > 0,
   // different random noise applied
 
+  // Unless they are redrawn every month, nets are only drawn when the event
+  // in force changes, or after the hosts were reset. Newborns get theirs in
+  // evolve
+  if (netsDrawn && !bedNetsRedrawnMonthly &&
+      netsCoverage == bn->getCoverage() && netsSysComp == bn->getSysComp())
+    return;
+
   bool firstTime = (u0CompBednets == std::numeric_limits<double>::max());
   bool sysCompChanged = (sysCompBednets != bn->getSysComp());
   bool coverageChanged =
@@ -1049,11 +1040,11 @@ void Population::updateBedNetCoverage(BedNetEvent *bn) {
   if (!bn->getCoverage()) { // cov can't be zero or u0CompBednets is infinite
 
     for (int i = 0; i < size; i++)
-      host_pop[i].bedNet = 0;
+      hosts.bedNet[i] = 0;
 
   } else {
 
-    double coverageScaleFactor = 0.0;
+    coverageScaleFactor = 0.0;
 
     if (firstTime || sysCompChanged) {
 
@@ -1069,12 +1060,12 @@ void Population::updateBedNetCoverage(BedNetEvent *bn) {
                                // probability so no need to draw from normal
                                // distribution
         for (int i = 0; i < size; i++)
-          host_pop[i].uCompBednets = u0CompBednets;
+          hosts.uCompBednets[i] = u0CompBednets;
       } else if (sysCompMDA <=
                  0) { // sysCompBednets non-zero so simple distribution,
                       // sysComMDA is zero or not set yet.
         for (int i = 0; i < size; i++)
-          host_pop[i].uCompBednets = stats.normal_dist(
+          hosts.uCompBednets[i] = stats.normal_dist(
               u0CompBednets, sqrt(bn->getSigma2())); // same fro norm dis of
                                                      // mean u0 and SD sigma
       } else {
@@ -1082,11 +1073,11 @@ void Population::updateBedNetCoverage(BedNetEvent *bn) {
         double sigmaMDA = sqrt(sysCompMDA / (1 - sysCompMDA));
         double sigmaBednets = sqrt(bn->getSigma2());
 
-        for (int i = 0; i < size; i++) // alters MDA compliance too. Maybe don't
-                                       // do this if not in an mda period
-          setU(host_pop[i], sigmaMDA,
-               sigmaBednets); // crashes if either input is zero. Sets
-                              // uCompBednets and uCompMDA
+        // alters MDA compliance too. Maybe don't do this if not in an mda
+        // period
+        setU(sigmaMDA,
+             sigmaBednets); // crashes if either input is zero. Sets
+                            // uCompBednets and uCompMDA
       }
 
     } else if (coverageChanged) {
@@ -1102,24 +1093,26 @@ void Population::updateBedNetCoverage(BedNetEvent *bn) {
     // apply new settings
 
     for (int i = 0; i < size; i++)
-      host_pop[i].bedNet =
-          (stats.normal_dist(host_pop[i].uCompBednets + coverageScaleFactor,
-                             1.0) < 0)
-              ? 1
-              : 0;
+      hosts.bedNet[i] = drawBedNet(i);
   }
 
   sysCompBednets = bn->getSysComp();
+  netsDrawn = true;
+  netsCoverage = bn->getCoverage();
+  netsSysComp = bn->getSysComp();
+  aggregates.recount(hosts);
 
-  if (_DEBUG) {
-    int nets = 0;
-    for (int i = 0; i < size; i++)
-      if (host_pop[i].bedNet)
-        nets++;
+  if (_DEBUG)
     std::cout << "specified coverage = " << bn->getCoverage()
-              << ", actual coverage = " << double(nets) / double(size)
+              << ", actual coverage = " << aggregates.bedNetCoverage()
               << std::endl;
-  }
+}
+
+char Population::drawBedNet(int i) {
+  return (stats.normal_dist(hosts.uCompBednets[i] + coverageScaleFactor, 1.0) <
+          0)
+             ? 1
+             : 0;
 }
 
 void Population::ApplyTreatment(MDAEvent *mda, Worm &worms, Scenario &sc, int t,
@@ -1138,7 +1131,7 @@ void Population::ApplyTreatment(MDAEvent *mda, Worm &worms, Scenario &sc, int t,
 
   u0CompMDA = calcU0(mda->getCoverage(), mda->getSigma2());
   for (int i = 0; i < size; i++)
-    host_pop[i].uCompMDA = stats.normal_dist(u0CompMDA, sqrt(mda->getSigma2()));
+    hosts.uCompMDA[i] = stats.normal_dist(u0CompMDA, sqrt(mda->getSigma2()));
   if (mda->getCoverage()) { // crashes if this is zero, but never should be
 
     double coverageScaleFactor = 0.0;
@@ -1159,13 +1152,13 @@ void Population::ApplyTreatment(MDAEvent *mda, Worm &worms, Scenario &sc, int t,
                                    // has an equal chance of complying each
                                    // round.
         for (int i = 0; i < size; i++)
-          host_pop[i].uCompMDA = u0CompMDA; // MDA value fixed for all hosts, ie
+          hosts.uCompMDA[i] = u0CompMDA; // MDA value fixed for all hosts, ie
                                             // no systematic adherence
 
       } else if (sysCompBednets <= 0) {
         // prevents crash if sysCompBednets = 0 AND sysCompMDA != 0
         for (int i = 0; i < size; i++)
-          host_pop[i].uCompMDA =
+          hosts.uCompMDA[i] =
               stats.normal_dist(u0CompMDA, sqrt(mda->getSigma2()));
 
       } else {
@@ -1175,14 +1168,11 @@ void Population::ApplyTreatment(MDAEvent *mda, Worm &worms, Scenario &sc, int t,
             sqrt(sysCompBednets /
                  (1 - sysCompBednets)); // if this is zero, setU will crash
 
-        for (int i = 0; i < size; i++) {
-          setU(
-              host_pop[i], sigmaMDA,
-              sigmaBednets); // uses sigmaMDA and u0CompMDA to set Host.uCompMDA
-          // The call to setU also affects bednet coverage.
-          // It will have changed hosts uCompBednets value. This will affect bed
-          // net use next month if bed net syscomp has not chnaged
-        }
+        setU(sigmaMDA,
+             sigmaBednets); // uses sigmaMDA and u0CompMDA to set Host.uCompMDA
+        // The call to setU also affects bednet coverage.
+        // It will have changed hosts uCompBednets value. This will affect bed
+        // net use next month if bed net syscomp has not chnaged
       }
 
     } else if (coverageChanged || (t == startTime)) {
@@ -1208,23 +1198,28 @@ void Population::ApplyTreatment(MDAEvent *mda, Worm &worms, Scenario &sc, int t,
 
     int hostsOldEnough = 0;
     int hostsTreated = 0;
+    DrugRegimen regimen = worms.getRegimen(mda->getType());
 
     for (int i = 0; i < size; i++) {
 
-      if (host_pop[i].age >= minAgeMDAinMonths) {
+      if (hosts.age[i] >= minAgeMDAinMonths) {
         hostsOldEnough++;
-        if (stats.normal_dist(host_pop[i].uCompMDA + coverageScaleFactor, 1.0) <
+        if (stats.normal_dist(hosts.uCompMDA[i] + coverageScaleFactor, 1.0) <
             0) {
-          if (host_pop[i].neverTreat == 0) {
+          if (hosts.neverTreat[i] == 0) {
 
-            host_pop[i].getsTreated(worms, mda->getType());
+            Host(hosts, i).getsTreated(regimen);
             hostsTreated++;
           }
         }
       }
     }
 
-    std::string type = mda->getType();
+    if (hostsTreated > 0) {
+      worms.setTreatedWith(regimen);
+      mfPositive.changed();
+    }
+
     //   std::cout << "Coverage = " << mda->getCoverage() << ", Actual
     //   coverage=" <<  double(hostsTreated)/hostsOldEnough <<std::endl ;
 
@@ -1266,39 +1261,44 @@ void Population::ApplyTreatmentUpdated(MDAEvent *mda, Worm &worms, Scenario &sc,
   std::vector<int> numHostsByAge(maxAge, 0);
 
   std::string MDAtype = mda->getType();
+  DrugRegimen regimen = worms.getRegimen(MDAtype);
+  bool anyTreated = false;
 
   for (int i = 0; i < size; i++) {
-    float flooredAge = std::floor(host_pop[i].age / 12);
+    float flooredAge = std::floor(hosts.age[i] / 12);
     int flooredAgeInt = std::min(static_cast<int>(flooredAge), maxAge - 1);
     numHostsByAge[flooredAgeInt] += 1;
     if (DoMDA) {
-      if (host_pop[i].age >= minAgeMDAinMonths) {
-        if (stats.uniform_dist() < host_pop[i].pTreat) {
-          if (host_pop[i].neverTreat == 0) {
-            host_pop[i].getsTreated(worms, MDAtype);
+      if (hosts.age[i] >= minAgeMDAinMonths) {
+        if (stats.uniform_dist() < hosts.pTreat[i]) {
+          if (hosts.neverTreat[i] == 0) {
+            Host(hosts, i).getsTreated(regimen);
             numTreatedByAge[flooredAgeInt] += 1;
+            anyTreated = true;
           }
         }
       }
     }
   }
+  if (anyTreated) {
+    worms.setTreatedWith(regimen);
+    mfPositive.changed();
+  }
   if ((outputEndgame == 1) && (t >= outputEndgameDate))
     sc.writeMDADataAllTreated(t, roundNumber, numTreatedByAge, numHostsByAge,
                               maxAge, rep, MDAtype, folderName);
 }
 
+double Population::getMeanWormBurden() const {
+  return aggregates.meanWormBurden();
+}
+
 double Population::getBedNetCoverage() const {
 
   // cant just return bedNetCov, as this might not be up to date
   // its only the vlaue used when syscomp last changed and u values generated.
-  // Instead, calculate actual proportion of hosts
-
-  int nets = 0;
-  for (int i = 0; i < size; i++)
-    if (host_pop[i].bedNet)
-      nets++;
-
-  return double(nets) / double(size);
+  // Instead, the actual proportion of hosts, kept as hosts change
+  return aggregates.bedNetCoverage();
 }
 
 double Population::getBedNetSysComp() const { return sysCompBednets; }
@@ -1313,6 +1313,46 @@ void Population::updateImportationRate(double factor) {
 
 void Population::clearSavedMonths() { savedMonths.clear(); }
 
+void Population::writeState(std::ostream &out) const {
+
+  out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  hosts.forEachColumn([&out, this](const auto &column) {
+    out.write(reinterpret_cast<const char *>(column.data()),
+              size * sizeof(column[0]));
+  });
+  out.write(reinterpret_cast<const char *>(&clock), sizeof(clock));
+
+  std::vector<char> rng = stats.getState();
+  std::uint64_t rngSize = rng.size();
+  out.write(reinterpret_cast<const char *>(&rngSize), sizeof(rngSize));
+  out.write(rng.data(), rng.size());
+}
+
+bool Population::readState(std::istream &in) {
+
+  int savedSize = 0;
+  in.read(reinterpret_cast<char *>(&savedSize), sizeof(savedSize));
+  if (!in || savedSize != size)
+    return false;
+  hosts.forEachColumn([&in, this](auto &column) {
+    in.read(reinterpret_cast<char *>(column.data()), size * sizeof(column[0]));
+  });
+  in.read(reinterpret_cast<char *>(&clock), sizeof(clock));
+  mfPositive.changed();
+  aggregates.recount(hosts);
+
+  std::uint64_t rngSize = 0;
+  in.read(reinterpret_cast<char *>(&rngSize), sizeof(rngSize));
+  if (!in)
+    return false;
+  std::vector<char> rng(rngSize);
+  in.read(rng.data(), rng.size());
+  if (!in)
+    return false;
+  stats.setState(rng);
+  return true;
+}
+
 // print random variables
 
 std::ostream &operator<<(std::ostream &ostr, const Population &pop) {
@@ -1345,65 +1385,25 @@ int Population::getMinAgePrev() const { return minAgePrev; }
 
 int Population::getMinAgeMDA() const { return minAgeMDA; }
 
-void Population::setU(Host &h, double sigmaMDA, double sigmaBednets) {
+void Population::setU(double sigmaMDA, double sigmaBednets) {
 
   // create correlation matrix and mean for multivariate normal distribution.
   // correlation betqeen sys comp for bednets and MDA
-  // called when applying either for the first ime or with a new sysComp value
-
-  gsl_matrix *m = gsl_matrix_alloc(3, 3);
-  gsl_matrix_set(m, 0, 0, 1.0);
-  gsl_matrix_set(m, 0, 1, sigmaMDA * rhoBU);
-  gsl_matrix_set(m, 1, 0, sigmaMDA * rhoBU);
-  gsl_matrix_set(m, 1, 1, sigmaMDA * sigmaMDA);
-  gsl_matrix_set(m, 2, 0, sigmaMDA * rhoCN * sigmaBednets);
-  gsl_matrix_set(m, 0, 2, sigmaMDA * rhoCN * sigmaBednets);
-  gsl_matrix_set(m, 2, 1, 0.0);
-  gsl_matrix_set(m, 1, 2, 0.0);
-  gsl_matrix_set(m, 2, 2, sigmaBednets * sigmaBednets);
-
-  // set mean vector
-  gsl_vector *v = gsl_vector_alloc(3);
-  gsl_vector_set(v, 0, 0.0);
-  gsl_vector_set(v, 1, u0CompMDA);
-  gsl_vector_set(v, 2, u0CompBednets);
-
-  // set result vector
-  gsl_vector *result = gsl_vector_alloc(3);
-  rmvnorm(3, v, m, result);
-
-  h.uCompMDA = (double)gsl_vector_get(result, 1);
-  h.uCompBednets = (double)gsl_vector_get(result, 2);
-
-  gsl_matrix_free(m);
-  gsl_vector_free(v);
-}
-
-void Population::rmvnorm(const int n, const gsl_vector *mean,
-                         const gsl_matrix *var, gsl_vector *result) {
-  /* multivariate normal distribution random number generator */
-  /*
-   * n dimension of the random vetor
-   * mean  vector of means of size n
-   * var variance matrix of dimension n x n
-   * result  output variable with a sigle random vector normal distribution
-   * generation
-   */
-
-  int k;
-  gsl_matrix *work = gsl_matrix_alloc(n, n);
-
-  gsl_matrix_memcpy(work, var);
-  gsl_linalg_cholesky_decomp(work); // decompose variance
-
-  for (k = 0; k < n; k++) // randomise result
-    gsl_vector_set(result, k, stats.unit_normal_dist());
-
-  gsl_blas_dtrmv(CblasLower, CblasNoTrans, CblasNonUnit, work,
-                 result);       // result = result + A, A'
-  gsl_vector_add(result, mean); // result = var*norm_distrib+mean
-
-  gsl_matrix_free(work);
+  // called when applying either for the first ime or with a new sysComp value.
+  // The same for every host, so factored once for all of them
+  const double covariance[3][3] = {
+      {1.0, sigmaMDA * rhoBU, sigmaMDA * rhoCN * sigmaBednets},
+      {sigmaMDA * rhoBU, sigmaMDA * sigmaMDA, 0.0},
+      {sigmaMDA * rhoCN * sigmaBednets, 0.0, sigmaBednets * sigmaBednets}};
+  CorrelatedNormal compliance(covariance);
+
+  const double mean[3] = {0.0, u0CompMDA, u0CompBednets};
+  double result[3];
+  for (int i = 0; i < size; i++) {
+    compliance.draw(mean, stats, result);
+    hosts.uCompMDA[i] = result[1];
+    hosts.uCompBednets[i] = result[2];
+  }
 }
 
 void Population::printMDAHistory() const {
@@ -1415,9 +1415,9 @@ void Population::printMDAHistory() const {
 
   for (int i = 0; i < size; i++) {
 
-    if (host_pop[i].age >= minAgeMDAinMonths) {
+    if (hosts.age[i] >= minAgeMDAinMonths) {
 
-      int num = host_pop[i].getNumMDAs();
+      int num = hosts.numMDAs[i];
       bins[num]++;
     }
   }
@@ -10,6 +10,9 @@
 #define Population_hpp
 
 #include "Host.hpp"
+#include "HostSnapshot.hpp"
+#include "MFPositive.hpp"
+#include "PopulationAggregates.hpp"
 #include "RecordedPrevalence.hpp"
 #include "Statistics.hpp"
 #include "Vector.hpp"
@@ -17,6 +20,7 @@
 #include <map>
 #include <random>
 #include <string>
+#include <vector>
 
 // class Vector;
 class Worm;
@@ -25,8 +29,7 @@ class PrevalenceEvent;
 class BedNetEvent;
 class TiXmlElement;
 class Scenario;
-
-#define MAX_POP 11550
+class AgeCensus;
 
 // class to represent a population
 // A container class for the Host class and also provides a size distribution
@@ -39,13 +42,6 @@ class Population {
 public:
   Population(TiXmlElement *xmlParameters);
 
-  ~Population() {
-    if (popSize != NULL)
-      delete[] popSize;
-    if (populationDistribution != NULL)
-      delete populationDistribution;
-  }
-
   void loadPopulationSize(const std::string filename);
   static int getMaxAge();
   int getLymphodemaTotalWorms();
@@ -59,7 +55,7 @@ public:
                    int rep, std::string folderName);
   int TASSurvey(Scenario &sc, int t, int outputEndgameDate, int rep,
                 std::string folderName);
-  RecordedPrevalence getPrevalence(PrevalenceEvent *outputPrev) const;
+  RecordedPrevalence getPrevalence(PrevalenceEvent *outputPrev);
 
   double getLarvalUptakebyVector(double r1, double kappas1,
                                  Vector::vectorSpecies species) const;
@@ -67,18 +63,17 @@ public:
   double getBedNetSysComp() const;
   double getImportationRateFactor() const;
   int getSizeOfPop() const;
+  Statistics &getStats() { return stats; }
+  const Statistics &getStats() const { return stats; }
 
   double getMFPrev(Scenario &sc, int forPreTass, int t, int outputEndgameDate,
                    int rep, int sampleSize, std::string folderName);
   bool test_for_infection(bool is_infected, float ICsensitivity,
                           float ICspecificity);
-  void getIncidence(Scenario &sc, int t, int rep, std::string folderName);
   double getMFPrevByAge(double ageStart, double ageEnd, bool sample);
-  double getNumberByAge(double ageStart, double ageEnd);
-  double HydroceleTestByAge(int ageStart, int ageEnd, int HydroceleTotalWorms,
-                            double HydroceleShape);
-  double LymphodemaTestByAge(int ageStart, int ageEnd, int LymphodemaTotalWorms,
-                             double LymphodemaShape);
+  double getMeanWormBurden() const;
+  void takeAgeCensus(AgeCensus &census);
+  std::vector<int> getNumbersByAge() const;
   void initPTreat(double cov, double rho);
   void editPTreat(double cov, double rho);
   void checkForZeroPTreat(double cov, double rho);
@@ -103,7 +98,23 @@ public:
                              std::string folderName);
   void saveCurrentState(int month, std::string sname);
   void resetToMonth(int month);
+  // Common random numbers. Every host variable and the random number
+  // generator are saved with each month and put back on reset, and each
+  // month's draws come from a stream of its own, seeded from seed and the
+  // month. Scenarios branching from a month then draw the same numbers month
+  // by month, so their differences are down to what they do differently
+  void setCommonRandomNumbers(bool common, unsigned long int seed);
+  // report the expected value of the sampled prevalences that are output,
+  // ie the mean chance of testing positive, rather than a sample. Surveys
+  // that decide what happens next still sample
+  void setExpectedPrevalence(bool expected) { expectedPrevalence = expected; }
+  // called at the start of month t of a scenario
+  void startMonth(int t);
   void clearSavedMonths();
+  // hosts and random number generator, as left by a burn-in. readState
+  // expects a population of the size that was written
+  void writeState(std::ostream &out) const;
+  bool readState(std::istream &in);
   double getICSens();
 
   double getICSpec();
@@ -164,17 +175,26 @@ public:
 
 private:
   double calcU0(double coverage, double sigma);
-  void setU(Host &h, double sigmaMDA, double sigmaBednets);
-  void rmvnorm(const int n, const gsl_vector *mean, const gsl_matrix *var,
-               gsl_vector *result);
+  // correlated MDA and bed net compliance for every host
+  void setU(double sigmaMDA, double sigmaBednets);
+  // whether host i uses a net, given its compliance
+  char drawBedNet(int i);
+  // 1 if a sampled mf test of host i is positive, 0 if not. With expected
+  // prevalence, the chance that it would be
+  double mfTestPositive(int i);
+
+  // random number generator for everything that happens to this population.
+  // Copied with the population and saved/restored with its state
+  Statistics stats;
 
   // param sampling
   std::default_random_engine randgen;
-  std::discrete_distribution<int> *populationDistribution;
-  int *popSize;
+  std::discrete_distribution<int> populationDistribution;
+  std::vector<int> popSize;
 
-  // The hosts
-  Host host_pop[MAX_POP];
+  // The hosts, stored column by column and sized to the population chosen in
+  // initHosts. Host(hosts, i) gives a view of host i
+  HostStore hosts;
 
   int size;
   // int sizeExtra;
@@ -212,6 +232,19 @@ private:
   double aImp_factor;
   double bedNetCov; // the value when syscomp last changed, ie the value used ot
                     // calculate hosts' u values
+  double coverageScaleFactor = 0.0; // shift of the u values for the coverage
+  // the bed net event the hosts' nets were last drawn for. netsDrawn is false
+  // until the first draw and after the hosts are reset
+  bool netsDrawn = false;
+  double netsCoverage;
+  double netsSysComp;
+  // draw every host's net each month, as well as at bed net events
+  bool bedNetsRedrawnMonthly = false;
+  // unless hostEventsDrawnMonthly is set, hosts die and are replaced by
+  // importations when this clock reaches the times drawn for them, rather
+  // than each host being tested for both every month
+  bool hostEventsDrawnMonthly = false;
+  eventClock clock = {0.0, 0.0};
   double mdaCoverage;
 
   int updateParams;
@@ -249,8 +282,10 @@ private:
 
   typedef struct {
 
-    std::vector<hostState> data;
+    HostSnapshot hosts;
+    std::vector<char> randomState; // of stats, with common random numbers
     int month;
+    eventClock clock;
     double aImp;
     double sysCompMDA;
     double sysCompBednets;
@@ -266,6 +301,10 @@ private:
     int TASSurveyTime;
     int preTAS_Pass;
     int TAS_Pass;
+    // restored with common random numbers
+    int time_TAS_Passes;
+    double ICsensitivity;
+    double ICspecificity;
     double prevCov;
     double prevRho;
     std::string
@@ -274,6 +313,12 @@ private:
   } savedMonth;
 
   std::vector<savedMonth> savedMonths;
+  bool commonRandomNumbers = false;
+  unsigned long int monthStreamSeed = 0;
+  bool expectedPrevalence = false;
+  std::vector<int> surveyOrder; // host indices in order, see getMFPrev
+  MFPositive mfPositive; // reset whenever M changes
+  PopulationAggregates aggregates; // bed nets and worms, see evolve
 };
 
 #endif /* Population_hpp */
@@ -0,0 +1,47 @@
+//
+//  PopulationAggregates.cpp
+//  transfil
+//
+//  Population-wide totals kept up to date as hosts change.
+//
+
+#include "PopulationAggregates.hpp"
+#include "HostStore.hpp"
+#include <cstdlib>
+#include <iostream>
+
+void PopulationAggregates::recount(const HostStore &hosts) {
+
+  size = hosts.size();
+  nets = 0;
+  worms = 0;
+  for (int i = 0; i < size; i++)
+    add(hosts, i);
+}
+
+void PopulationAggregates::remove(const HostStore &hosts, int i) {
+
+  nets -= hosts.bedNet[i] ? 1 : 0;
+  worms -= hosts.totalWorms[i];
+}
+
+void PopulationAggregates::add(const HostStore &hosts, int i) {
+
+  nets += hosts.bedNet[i] ? 1 : 0;
+  worms += hosts.totalWorms[i];
+}
+
+void PopulationAggregates::check(const HostStore &hosts,
+                                 std::string where) const {
+
+  PopulationAggregates scan;
+  scan.recount(hosts);
+  if (scan.size != size || scan.nets != nets || scan.worms != worms) {
+    std::cout << "Error in PopulationAggregates::check. Totals out of date in "
+              << where << ": " << size << " hosts, " << nets << " nets, "
+              << worms << " worms but a scan gives " << scan.size
+              << " hosts, " << scan.nets << " nets, " << scan.worms
+              << " worms" << std::endl;
+    exit(1);
+  }
+}
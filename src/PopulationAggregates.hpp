@@ -0,0 +1,43 @@
+//
+//  PopulationAggregates.hpp
+//  transfil
+//
+//  Population-wide totals kept up to date as hosts change.
+//
+
+#ifndef PopulationAggregates_hpp
+#define PopulationAggregates_hpp
+
+#include <string>
+
+class HostStore;
+
+// Bed net coverage is read by the vectors every time step and by the monthly
+// output, and mean worm burden by the equilibrium check, so rather than
+// walking the hosts for each read the totals are kept here. Population calls
+// remove() before a host changes and add() after it, or recount() after
+// changing many hosts at once.
+
+class PopulationAggregates {
+
+public:
+  // totals from scratch, for the first hosts.size() hosts
+  void recount(const HostStore &hosts);
+
+  void remove(const HostStore &hosts, int i);
+  void add(const HostStore &hosts, int i);
+
+  double bedNetCoverage() const { return double(nets) / double(size); }
+  double meanWormBurden() const { return double(worms) / size; }
+
+  // compares the totals with a full scan of the hosts, and exits if they
+  // differ. where names the caller for the error message
+  void check(const HostStore &hosts, std::string where) const;
+
+private:
+  int size = 0;
+  int nets = 0;        // hosts with a bed net
+  long long worms = 0; // sum of totalWorms
+};
+
+#endif /* PopulationAggregates_hpp */
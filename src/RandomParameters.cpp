@@ -0,0 +1,109 @@
+//
+//  RandomParameters.cpp
+//  transfil
+//
+//  The fitted parameter sets given with -p, one line per replicate.
+//
+
+#include "RandomParameters.hpp"
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+void RandomParameters::load(std::string fname, unsigned replicates) {
+
+  std::ifstream infile(fname, std::ios_base::in | std::ios_base::binary);
+  if (!infile.is_open()) {
+    std::cout << "Error in RandomParameters::load. Cannot read file " << fname
+              << std::endl;
+    exit(1);
+  }
+  std::ostringstream text;
+  text << infile.rdbuf();
+  parse(text.str(), replicates, fname);
+}
+
+void RandomParameters::parse(const std::string &text, unsigned replicates,
+                             std::string source) {
+
+  this->replicates = replicates;
+  years = 0;
+  values.clear();
+
+  const char *pos = text.data();
+  const char *end = text.data() + text.size();
+  for (unsigned line = 1; line <= replicates; line++) {
+
+    if (pos == end) {
+      std::cout << "Error in RandomParameters::parse. " << source
+                << " is too short for " << replicates << " replicates"
+                << std::endl;
+      exit(1);
+    }
+    const char *eol = pos;
+    while (eol != end && *eol != '\n')
+      eol++;
+
+    // whitespace separated values, as read by >>
+    std::size_t lineStart = values.size();
+    while (true) {
+      while (pos != eol && isspace((unsigned char)*pos))
+        pos++;
+      if (pos == eol)
+        break;
+      if (*pos == '+')
+        pos++;
+      double value;
+      std::from_chars_result read = std::from_chars(pos, eol, value);
+      if (read.ec != std::errc() ||
+          (read.ptr != eol && !isspace((unsigned char)*read.ptr))) {
+        std::cout << "Error in RandomParameters::parse. Cannot read a number "
+                     "on line "
+                  << line << " of " << source << std::endl;
+        exit(1);
+      }
+      values.push_back(value);
+      pos = read.ptr;
+    }
+
+    std::size_t numValues = values.size() - lineStart;
+    if (numValues == 0 || numValues % VALUES_PER_YEAR != 0) {
+      std::cout << "Error in RandomParameters::parse. Line " << line << " of "
+                << source << " has " << numValues
+                << " values, which is not v_to_h, k, aImp and wPropMDA for a "
+                   "whole number of years"
+                << std::endl;
+      exit(1);
+    }
+    if (line == 1)
+      years = numValues / VALUES_PER_YEAR;
+    else if ((int)numValues != years * VALUES_PER_YEAR) {
+      std::cout << "Error in RandomParameters::parse. Line " << line << " of "
+                << source << " has " << numValues / VALUES_PER_YEAR
+                << " years of values, line 1 has " << years << std::endl;
+      exit(1);
+    }
+    pos = (eol == end) ? end : eol + 1;
+  }
+}
+
+void RandomParameters::getReplicate(int rep, std::vector<double> &k_vals,
+                                    std::vector<double> &v_to_h_vals,
+                                    std::vector<double> &aImp_vals,
+                                    std::vector<double> &wProp_vals) const {
+
+  k_vals.resize(years);
+  v_to_h_vals.resize(years);
+  aImp_vals.resize(years);
+  wProp_vals.resize(years);
+
+  const double *row = values.data() + (std::size_t)rep * years * VALUES_PER_YEAR;
+  for (int y = 0; y < years; y++, row += VALUES_PER_YEAR) {
+    v_to_h_vals[y] = row[V_TO_H];
+    k_vals[y] = row[K];
+    aImp_vals[y] = row[AIMP];
+    wProp_vals[y] = row[WPROP];
+  }
+}
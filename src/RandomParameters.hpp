@@ -0,0 +1,45 @@
+//
+//  RandomParameters.hpp
+//  transfil
+//
+//  The fitted parameter sets given with -p, one line per replicate.
+//
+
+#ifndef RandomParameters_hpp
+#define RandomParameters_hpp
+
+#include <string>
+#include <vector>
+
+// Each line holds one replicate's values of v_to_h, k, aImp and wPropMDA for
+// each year in turn, so 4 values per year. The file is read once and held as
+// a replicate x year x value matrix. Every line used must have the same,
+// whole, number of years.
+
+class RandomParameters {
+
+public:
+  // the values for the first replicates lines of fname
+  void load(std::string fname, unsigned replicates);
+  // as load, with the file's text. source names it in error messages
+  void parse(const std::string &text, unsigned replicates, std::string source);
+
+  int getNumReplicates() const { return replicates; }
+  int getNumYears() const { return years; }
+
+  // one value per year for replicate rep
+  void getReplicate(int rep, std::vector<double> &k_vals,
+                    std::vector<double> &v_to_h_vals,
+                    std::vector<double> &aImp_vals,
+                    std::vector<double> &wProp_vals) const;
+
+private:
+  // order of the values for each year
+  enum { V_TO_H, K, AIMP, WPROP, VALUES_PER_YEAR };
+
+  int replicates = 0;
+  int years = 0;
+  std::vector<double> values; // VALUES_PER_YEAR * years per replicate
+};
+
+#endif /* RandomParameters_hpp */
@@ -0,0 +1,105 @@
+//
+//  ReplicateStopping.cpp
+//  transfil
+//
+//  Decides when enough replicates have been run to pin down the headlines.
+//
+
+#include "ReplicateStopping.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+void ReplicateStopping::add(int s, int rep, double mfPrevalence,
+                            bool reachedEPHP) {
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if ((int)mfPrev[s].size() <= rep) {
+    mfPrev[s].resize(rep + 1, 0.0);
+    ephp[s].resize(rep + 1, 0.0);
+  }
+  mfPrev[s][rep] = mfPrevalence;
+  ephp[s][rep] = reachedEPHP ? 1.0 : 0.0;
+}
+
+ReplicateStopping::estimate
+ReplicateStopping::mfPrevalence(int s, int reps) const {
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<double> u = units(mfPrev[s], reps);
+  int n = u.size();
+
+  // no spread can be estimated from a single unit
+  estimate e = {0.0, HUGE_VAL};
+  if (n < 1)
+    return e;
+  e.mean = mean(u);
+  if (n < 2)
+    return e;
+  e.halfWidth = 1.96 * std::sqrt(squares(u, e.mean) / (n - 1) / n);
+  return e;
+}
+
+ReplicateStopping::estimate ReplicateStopping::EPHP(int s, int reps) const {
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<double> u = units(ephp[s], reps);
+  int n = u.size();
+
+  estimate e = {0.0, HUGE_VAL};
+  if (n < 1)
+    return e;
+  e.mean = mean(u);
+
+  // a proportion of 0 or 1 has no spread, so as in Agresti and Coull's
+  // interval two successes and two failures are added. For single replicates
+  // this gives exactly their half-width
+  double adjusted = (e.mean * n + 2) / (n + 4);
+  double spread = squares(u, adjusted) + 2 * adjusted * adjusted +
+                  2 * (1 - adjusted) * (1 - adjusted);
+  e.halfWidth = 1.96 * std::sqrt(spread / (n + 4) / (n + 4));
+  return e;
+}
+
+bool ReplicateStopping::precise(int reps) const {
+
+  for (unsigned s = 0; s < mfPrev.size(); s++)
+    if (mfPrevalence(s, reps).halfWidth > halfWidth ||
+        EPHP(s, reps).halfWidth > halfWidth)
+      return false;
+  return true;
+}
+
+std::vector<double> ReplicateStopping::units(const std::vector<double> &values,
+                                             int reps) const {
+
+  if ((int)values.size() < reps || (pairs && reps % 2)) {
+    std::cout << "Error in ReplicateStopping::units. Only " << values.size()
+              << " of " << reps << " replicates recorded, or a pair is split"
+              << std::endl;
+    exit(1);
+  }
+
+  if (!pairs)
+    return std::vector<double>(values.begin(), values.begin() + reps);
+  std::vector<double> u(reps / 2);
+  for (int k = 0; k < reps / 2; k++)
+    u[k] = (values[2 * k] + values[2 * k + 1]) / 2;
+  return u;
+}
+
+double ReplicateStopping::mean(const std::vector<double> &u) {
+
+  double sum = 0.0;
+  for (double x : u)
+    sum += x;
+  return sum / u.size();
+}
+
+double ReplicateStopping::squares(const std::vector<double> &u, double about) {
+
+  double sum = 0.0;
+  for (double x : u)
+    sum += (x - about) * (x - about);
+  return sum;
+}
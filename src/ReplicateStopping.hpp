@@ -0,0 +1,63 @@
+//
+//  ReplicateStopping.hpp
+//  transfil
+//
+//  Decides when enough replicates have been run to pin down the headlines.
+//
+
+#ifndef ReplicateStopping_hpp
+#define ReplicateStopping_hpp
+
+#include <mutex>
+#include <vector>
+
+// Takes two headline values from each scenario of each replicate: the mf
+// prevalence in a target year, and whether the replicate reached EPHP (passed
+// the required TAS surveys) by the end of the scenario. The year EPHP is
+// reached is not used, as replicates that never reach it have no year.
+//
+// After replicates 0 to reps-1 are all in, each headline is estimated by its
+// mean over the units, with a 95% confidence interval half-width of
+// 1.96 sd / sqrt(units), or for EPHP that of the Agresti-Coull interval for a
+// proportion. The units are the replicates, or with antithetic pairs the
+// averages of replicates 2k and 2k+1, as the two are not independent.
+// Values are kept by replicate and summed in that order, so the estimates
+// don't depend on the order in which replicates finish.
+
+class ReplicateStopping {
+
+public:
+  ReplicateStopping(double halfWidth, int numScenarios, bool pairs = false)
+      : halfWidth(halfWidth), pairs(pairs), mfPrev(numScenarios),
+        ephp(numScenarios) {}
+
+  // may be called from several threads at once
+  void add(int s, int rep, double mfPrevalence, bool reachedEPHP);
+
+  typedef struct {
+
+    double mean;
+    double halfWidth;
+
+  } estimate;
+
+  estimate mfPrevalence(int s, int reps) const;
+  estimate EPHP(int s, int reps) const;
+
+  // true if every headline of every scenario is within the half-width
+  bool precise(int reps) const;
+
+private:
+  // the first reps values, or the averages of the first reps/2 pairs
+  std::vector<double> units(const std::vector<double> &values, int reps) const;
+  static double mean(const std::vector<double> &u);
+  static double squares(const std::vector<double> &u, double about);
+
+  double halfWidth;
+  bool pairs;
+  std::vector<std::vector<double>> mfPrev; // by scenario then replicate
+  std::vector<std::vector<double>> ephp;   // 1 if EPHP reached, else 0
+  mutable std::mutex mutex;
+};
+
+#endif /* ReplicateStopping_hpp */
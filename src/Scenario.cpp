@@ -7,9 +7,12 @@
 //
 
 #include "Scenario.hpp"
+#include "AgeCensus.hpp"
 #include "Output.hpp"
 #include <cassert>
 #include <filesystem>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <sys/stat.h>
@@ -34,13 +37,8 @@ void Scenario::updateImportationRate(Population &popln, int month) {
 
 BedNetEvent *Scenario::getBedNetCoverage(int month) const {
 
-  // If NULL pointer, go back to the last month it was defined.
-  // bedNetCoverage[0] guaranteed not to be null
-  BedNetEvent *bn = NULL;
-  while (!(bn = bedNetCoverage[month]))
-    month--;
-
-  return bn; // never NULL
+  // the event in force, filled in for every month by the constructor
+  return bedNetCoverage[month]; // never NULL
 }
 
 double Scenario::getImportationFactor(int month) const {
@@ -203,47 +201,52 @@ void Scenario::openFileandPrintHeadings(std::string region, Output &results) {
 
 void Scenario::printResults(int repnum, Output &results, Population &popln) {
 
-  // caled at the end of each replicate
+  // caled at the end of each replicate. Rows are built in memory and handed to
+  // writeResults, as replicates may finish out of order when run in parallel
+
+  std::ostringstream resIC, resMF, resWC;
+  std::ostringstream resExtraIC, resExtraMF, resExtraWC;
+  std::vector<std::ostringstream> resPop(popAgeRanges.size());
 
   if (ICNeeded) {
     if (!repnum)
-      printColumnTitles(myFileIC, results);
-    printReplicate(myFileIC, results, repnum,
+      printColumnTitles(resIC, results);
+    printReplicate(resIC, results, repnum,
                    popln); // print randaom values used in this replicate
   }
   if (MFNeeded) {
     if (!repnum)
-      printColumnTitles(myFileMF, results);
-    printReplicate(myFileMF, results, repnum, popln);
+      printColumnTitles(resMF, results);
+    printReplicate(resMF, results, repnum, popln);
   }
   if (WCNeeded) {
     if (!repnum)
-      printColumnTitles(myFileWC, results);
-    printReplicate(myFileWC, results, repnum, popln);
+      printColumnTitles(resWC, results);
+    printReplicate(resWC, results, repnum, popln);
   }
 
   for (int i = 0; i < popAgeRanges.size(); i++) {
     if (!repnum)
-      printColumnTitles(popFiles[i], results);
-    printReplicate(popFiles[i], results, repnum, popln);
+      printColumnTitles(resPop[i], results);
+    printReplicate(resPop[i], results, repnum, popln);
   }
 
   if (requiresExtra) {
 
     if (ICNeeded) {
       if (!repnum)
-        printColumnTitles(myFileExtraIC, results, true);
-      printReplicate(myFileExtraIC, results, repnum, popln);
+        printColumnTitles(resExtraIC, results, true);
+      printReplicate(resExtraIC, results, repnum, popln);
     }
     if (MFNeeded) {
       if (!repnum)
-        printColumnTitles(myFileExtraMF, results, true);
-      printReplicate(myFileExtraMF, results, repnum, popln);
+        printColumnTitles(resExtraMF, results, true);
+      printReplicate(resExtraMF, results, repnum, popln);
     }
     if (WCNeeded) {
       if (!repnum)
-        printColumnTitles(myFileExtraWC, results, true);
-      printReplicate(myFileExtraWC, results, repnum, popln);
+        printColumnTitles(resExtraWC, results, true);
+      printReplicate(resExtraWC, results, repnum, popln);
     }
   }
 
@@ -266,35 +269,35 @@ void Scenario::printResults(int repnum, Output &results, Population &popln) {
         int lower = popAgeRanges[i];
         int upper =
             (i < (popAgeRanges.size() - 1)) ? popAgeRanges[i + 1] - 1 : -1;
-        popFiles[i] << "\t"
+        resPop[i] << "\t"
                     << prevalence->getAgeInRange(lower,
                                                  upper); // range is inclusive
 
       } else
-        popFiles[i] << "\t "; // placeholder, just mda needed for this month
+        resPop[i] << "\t "; // placeholder, just mda needed for this month
     }
 
     if (ICNeeded) {
       if (prevalence)
-        myFileIC << "\t" << prevalence->IC;
+        resIC << "\t" << prevalence->IC;
       else
-        myFileIC << "\t"
+        resIC << "\t"
                  << " "; // placeholder, just mda needed for this month
     }
 
     if (MFNeeded) {
       if (prevalence)
-        myFileMF << "\t" << prevalence->MF;
+        resMF << "\t" << prevalence->MF;
       else
-        myFileMF << "\t"
+        resMF << "\t"
                  << " ";
     }
 
     if (WCNeeded) {
       if (prevalence)
-        myFileWC << "\t" << prevalence->WC;
+        resWC << "\t" << prevalence->WC;
       else
-        myFileWC << "\t"
+        resWC << "\t"
                  << " ";
     }
 
@@ -303,73 +306,124 @@ void Scenario::printResults(int repnum, Output &results, Population &popln) {
       if (ICNeeded) {
 
         if (prevalence)
-          myFileExtraIC << "\t" << prevalence->ICRestrictedAge;
+          resExtraIC << "\t" << prevalence->ICRestrictedAge;
         else
-          myFileExtraIC << "\t"
+          resExtraIC << "\t"
                         << " "; // placeholder, just mda needed for this month
       }
 
       if (MFNeeded) {
 
         if (prevalence)
-          myFileExtraMF << "\t" << prevalence->MFRestrictedAge;
+          resExtraMF << "\t" << prevalence->MFRestrictedAge;
         else
-          myFileExtraMF << "\t"
+          resExtraMF << "\t"
                         << " ";
       }
 
       if (WCNeeded) {
 
         if (prevalence)
-          myFileExtraWC << "\t" << prevalence->WCRestrictedAge;
+          resExtraWC << "\t" << prevalence->WCRestrictedAge;
         else
-          myFileExtraWC << "\t"
+          resExtraWC << "\t"
                         << " ";
       }
     }
   }
 
   if (ICNeeded) {
-    myFileIC << "\t" << popln.totMDAs;
-    myFileIC << "\t" << popln.post2020MDAs;
-    myFileIC << "\t" << popln.numPreTASSurveys;
-    myFileIC << "\t" << popln.numTASSurveys;
-    myFileIC << "\t" << popln.time_TAS_Passes;
-    myFileIC << std::endl;
+    resIC << "\t" << popln.totMDAs;
+    resIC << "\t" << popln.post2020MDAs;
+    resIC << "\t" << popln.numPreTASSurveys;
+    resIC << "\t" << popln.numTASSurveys;
+    resIC << "\t" << popln.time_TAS_Passes;
+    resIC << std::endl;
   }
 
   if (MFNeeded) {
-    myFileMF << "\t" << popln.totMDAs;
-    myFileMF << "\t" << popln.post2020MDAs;
-    myFileMF << "\t" << popln.numPreTASSurveys;
-    myFileMF << "\t" << popln.numTASSurveys;
-    myFileMF << "\t" << popln.time_TAS_Passes;
-    myFileMF << std::endl;
+    resMF << "\t" << popln.totMDAs;
+    resMF << "\t" << popln.post2020MDAs;
+    resMF << "\t" << popln.numPreTASSurveys;
+    resMF << "\t" << popln.numTASSurveys;
+    resMF << "\t" << popln.time_TAS_Passes;
+    resMF << std::endl;
   }
 
   if (WCNeeded) {
-    myFileWC << "\t" << popln.totMDAs;
-    myFileWC << "\t" << popln.post2020MDAs;
-    myFileWC << "\t" << popln.numPreTASSurveys;
-    myFileWC << "\t" << popln.numTASSurveys;
-    myFileWC << "\t" << popln.time_TAS_Passes;
-    myFileWC << std::endl;
+    resWC << "\t" << popln.totMDAs;
+    resWC << "\t" << popln.post2020MDAs;
+    resWC << "\t" << popln.numPreTASSurveys;
+    resWC << "\t" << popln.numTASSurveys;
+    resWC << "\t" << popln.time_TAS_Passes;
+    resWC << std::endl;
   }
 
   if (requiresExtra) {
     if (ICNeeded)
-      myFileExtraIC << std::endl;
+      resExtraIC << std::endl;
     if (MFNeeded)
-      myFileExtraMF << std::endl;
+      resExtraMF << std::endl;
     if (WCNeeded)
-      myFileExtraWC << std::endl;
+      resExtraWC << std::endl;
   }
 
   for (int i = 0; i < popAgeRanges.size(); i++)
-    popFiles[i] << std::endl;
+    resPop[i] << std::endl;
+
+  ReplicateResults res;
+  res.IC = resIC.str();
+  res.MF = resMF.str();
+  res.WC = resWC.str();
+  res.extraIC = resExtraIC.str();
+  res.extraMF = resExtraMF.str();
+  res.extraWC = resExtraWC.str();
+  for (int i = 0; i < popAgeRanges.size(); i++)
+    res.pop.push_back(resPop[i].str());
+
+  writeResults(repnum, res);
 }
 
-void Scenario::printColumnTitles(std::ofstream &of, Output &results,
+void Scenario::writeResults(int repnum, const ReplicateResults &res) {
+
+  // hold rows until every earlier replicate has been written, so the summary
+  // files are in replicate order whatever order the replicates finish in
+
+  std::lock_guard<std::mutex> lock(*resultsMutex);
+
+  pendingResults[repnum] = res;
+
+  std::map<int, ReplicateResults>::iterator next;
+  while ((next = pendingResults.find(nextRepToWrite)) !=
+         pendingResults.end()) {
+
+    ReplicateResults &r = next->second;
+
+    if (ICNeeded)
+      myFileIC << r.IC;
+    if (MFNeeded)
+      myFileMF << r.MF;
+    if (WCNeeded)
+      myFileWC << r.WC;
+
+    if (requiresExtra) {
+      if (ICNeeded)
+        myFileExtraIC << r.extraIC;
+      if (MFNeeded)
+        myFileExtraMF << r.extraMF;
+      if (WCNeeded)
+        myFileExtraWC << r.extraWC;
+    }
+
+    for (int i = 0; i < popAgeRanges.size(); i++)
+      popFiles[i] << r.pop[i];
+
+    pendingResults.erase(next);
+    nextRepToWrite++;
+  }
+}
+
+void Scenario::printColumnTitles(std::ostream &of, Output &results,
                                  bool extra) const {
 
   std::string indent(results.getNumRandomVars() + 2, '\t');
@@ -445,7 +499,7 @@ void Scenario::printColumnTitles(std::ofstream &of, Output &results,
   of << std::endl;
 }
 
-void Scenario::printReplicate(std::ofstream &of, Output &results, int repnum,
+void Scenario::printReplicate(std::ostream &of, Output &results, int repnum,
                               Population &popln) const {
 
   of << (repnum + 1);
@@ -498,21 +552,7 @@ bool Scenario::requiresWC() const { return WCNeeded; }
 void Scenario::InitIHMEData(int rep, std::string folder) {
   // get mf prevalence
 
-  struct stat buffer;
-
-  std::string fname;
-  std::string fname2;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/IHME_scen" + name +
-          "_rep_" + rep1 + ".csv";
-  fname2 = folder + "/IHME_scen" + fol_n + "/" + name;
-  if (stat(fname2.c_str(), &buffer) != 0) {
-    fs::create_directories(fname2);
-  }
-  std::ofstream outfile;
-  outfile.open(fname);
+  std::ostream &outfile = outputFile(IHMEOutput, rep, folder, true);
   if (rep == 0) {
     outfile << "espen_loc"
             << ","
@@ -530,28 +570,12 @@ void Scenario::InitIHMEData(int rep, std::string folder) {
     outfile << "draw_0"
             << "\n";
   }
-
-  outfile.close();
 }
 
 void Scenario::InitPreTASData(int rep, std::string folder) {
   // get mf prevalence
 
-  struct stat buffer;
-
-  std::string fname;
-  std::string fname2;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/PreTAS_scen" + name +
-          "_rep_" + rep1 + ".csv";
-  fname2 = folder + "/IHME_scen" + fol_n + "/" + name;
-  if (stat(fname2.c_str(), &buffer) != 0) {
-    fs::create_directories(fname2);
-  }
-  std::ofstream outfile;
-  outfile.open(fname);
+  std::ostream &outfile = outputFile(PreTASOutput, rep, folder, true);
   if (rep == 0) {
     outfile << "espen_loc"
             << ","
@@ -569,28 +593,12 @@ void Scenario::InitPreTASData(int rep, std::string folder) {
     outfile << "draw_0"
             << "\n";
   }
-
-  outfile.close();
 }
 
 void Scenario::InitTASData(int rep, std::string folder) {
   // get mf prevalence
 
-  struct stat buffer;
-
-  std::string fname;
-  std::string fname2;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/TAS_scen" + name +
-          "_rep_" + rep1 + ".csv";
-  fname2 = folder + "/IHME_scen" + fol_n + "/" + name;
-  if (stat(fname2.c_str(), &buffer) != 0) {
-    fs::create_directories(fname2);
-  }
-  std::ofstream outfile;
-  outfile.open(fname);
+  std::ostream &outfile = outputFile(TASOutput, rep, folder, true);
   if (rep == 0) {
     outfile << "espen_loc"
             << ","
@@ -608,38 +616,26 @@ void Scenario::InitTASData(int rep, std::string folder) {
     outfile << "draw_0"
             << "\n";
   }
-
-  outfile.close();
 }
 
-void Scenario::writePrevByAge(Population &popln, int t, int rep,
+void Scenario::writePrevByAge(const AgeCensus &census, int t, int rep,
                               std::string folder) {
   // get mf prevalence
-  std::ofstream outfile;
-  int maxAge = popln.getMaxAge();
-  std::string fname;
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-  std::string rep1 = std::to_string(rep);
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/IHME_scen" + name +
-          "_rep_" + rep1 + ".csv";
+  int maxAge = census.mfPrev.size();
   int year = t / 12 + 2000;
-  outfile.open(fname, std::ios::app);
+  std::ostream &outfile = outputFile(IHMEOutput, rep, folder);
 
-  bool sample = true;
   if (rep == 0) {
     for (int j = 0; j < maxAge; j++) {
       outfile << name << "," << year << "," << j << "," << j + 1 << ","
               << "prevalence"
-              << "," << popln.getMFPrevByAge(j, j + 1, sample) << "\n";
+              << "," << census.mfPrev[j] << "\n";
     }
   } else {
     for (int j = 0; j < maxAge; j++) {
-      outfile << popln.getMFPrevByAge(j, j + 1, sample) << "\n";
+      outfile << census.mfPrev[j] << "\n";
     }
   }
-
-  outfile.close();
 }
 
 void Scenario::writeRoadmapTarget(Population &popln, int t, int rep, int DoMDA,
@@ -653,15 +649,9 @@ void Scenario::writeRoadmapTarget(Population &popln, int t, int rep, int DoMDA,
   // have passed the TAS survey as many times as stated by neededTASPass. This
   // is all done so that there are some easy to use values for each year that
   // can be used for making plots.
-  std::ofstream outfile;
   int maxAge = popln.getMaxAge();
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-  std::string rep1 = std::to_string(rep);
-  std::string fname = folder + "/NTDMC_scen" + fol_n + "/" + name +
-                      "/NTDMC_scen" + name + "_rep_" + rep1 + ".csv";
   int year = t / 12 + 2000;
-  outfile.open(fname, std::ios::app);
+  std::ostream &outfile = outputFile(NTDMCOutput, rep, folder);
   bool sample = true;
   float mfprevSample = popln.getMFPrevByAge(5, maxAge, sample);
   float ICprevSample = popln.getICPrevForOutput(sample);
@@ -708,28 +698,13 @@ void Scenario::writeRoadmapTarget(Population &popln, int t, int rep, int DoMDA,
     outfile << 1 - DoMDA << "\n";
     outfile << achieveEPHP << "\n";
   }
-
-  outfile.close();
 }
 
-void Scenario::writeIncidence(int t, int *incidence, int maxAge, int rep,
+void Scenario::writeIncidence(int t, const std::vector<int> &incidence, int rep,
                               std::string folder) {
-  std::ofstream outfile;
-  std::string fname;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/IHME_scen" + name +
-          "_rep_" + rep1 + ".csv";
+  int maxAge = incidence.size();
   int year = t / 12 + 2000;
-
-  outfile.open(fname, std::ios::app);
-  if (!outfile.is_open()) {
-    std::cerr << "Error: Unable to open file " << fname << " for writing."
-              << std::endl;
-    return; // Or handle the error appropriately
-  }
+  std::ostream &outfile = outputFile(IHMEOutput, rep, folder);
   if (rep == 0) {
     for (int j = 0; j < maxAge; j++) {
       outfile << name << "," << year << "," << j << "," << j + 1 << ","
@@ -740,122 +715,72 @@ void Scenario::writeIncidence(int t, int *incidence, int maxAge, int rep,
       outfile << incidence[j] << "\n";
     }
   }
-
-  outfile.close();
 }
 
-void Scenario::writeNumberByAge(Population &popln, int t, int rep,
-                                std::string folder, std::string surveyType) {
+void Scenario::writeNumberByAge(const std::vector<int> &numberByAge, int t,
+                                int rep, std::string folder,
+                                std::string surveyType) {
   // get mf prevalence
-  std::ofstream outfile;
-  int maxAge = popln.getMaxAge();
-  std::string fname;
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-  std::string rep1 = std::to_string(rep);
+  int maxAge = numberByAge.size();
   std::string entry = "number";
+  OutputStream stream;
   if (surveyType == "PreTAS survey") {
-    fname = folder + "/IHME_scen" + fol_n + "/" + name + "/PreTAS_scen" + name +
-            "_rep_" + rep1 + ".csv";
+    stream = PreTASOutput;
     entry = "Pre TAS number";
   } else if (surveyType == "TAS survey") {
-    fname = folder + "/IHME_scen" + fol_n + "/" + name + "/TAS_scen" + name +
-            "_rep_" + rep1 + ".csv";
+    stream = TASOutput;
     entry = "TAS number";
   } else {
-    fname = folder + "/IHME_scen" + fol_n + "/" + name + "/IHME_scen" + name +
-            "_rep_" + rep1 + ".csv";
+    stream = IHMEOutput;
     entry = "number";
   }
 
   int year = t / 12 + 2000;
-
-  outfile.open(fname, std::ios::app);
+  std::ostream &outfile = outputFile(stream, rep, folder);
   if (rep == 0) {
     for (int j = 0; j < maxAge; j++) {
       outfile << name << "," << year << "," << j << "," << j + 1 << "," << entry
-              << "," << popln.getNumberByAge(j, j + 1) << "\n";
+              << "," << numberByAge[j] << "\n";
     }
   } else {
     for (int j = 0; j < maxAge; j++) {
-      outfile << popln.getNumberByAge(j, j + 1) << "\n";
+      outfile << numberByAge[j] << "\n";
     }
   }
-
-  outfile.close();
 }
 
-void Scenario::writeSequelaeByAge(Population &popln, int t,
-                                  int LymphodemaTotalWorms,
-                                  double LymphodemaShape,
-                                  int HydroceleTotalWorms,
-                                  double HydroceleShape, int rep,
+void Scenario::writeSequelaeByAge(const AgeCensus &census, int t, int rep,
                                   std::string folder) {
   // get mf prevalence
-  std::ofstream outfile;
-  int maxAge = popln.getMaxAge();
-  std::string fname;
+  int maxAge = census.hydrocele.size();
 
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-  std::string rep1 = std::to_string(rep);
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/IHME_scen" + name +
-          "_rep_" + rep1 + ".csv";
 
   int year = t / 12 + 2000;
-
-  outfile.open(fname, std::ios::app);
+  std::ostream &outfile = outputFile(IHMEOutput, rep, folder);
   if (rep == 0) {
     for (int j = 0; j < maxAge; j++) {
       outfile << name << "," << year << "," << j << "," << j + 1 << ","
               << "Hydrocele"
-              << ","
-              << popln.HydroceleTestByAge(j, j + 1, HydroceleTotalWorms,
-                                          HydroceleShape)
-              << "\n";
+              << "," << census.hydrocele[j] << "\n";
     }
     for (int j = 0; j < maxAge; j++) {
       outfile << name << "," << year << "," << j << "," << j + 1 << ","
               << "Lymphodema"
-              << ","
-              << popln.LymphodemaTestByAge(j, j + 1, LymphodemaTotalWorms,
-                                           LymphodemaShape)
-              << "\n";
+              << "," << census.lymphodema[j] << "\n";
     }
   } else {
     for (int j = 0; j < maxAge; j++) {
-      outfile << popln.HydroceleTestByAge(j, j + 1, HydroceleTotalWorms,
-                                          HydroceleShape)
-              << "\n";
+      outfile << census.hydrocele[j] << "\n";
     }
     for (int j = 0; j < maxAge; j++) {
-      outfile << popln.LymphodemaTestByAge(j, j + 1, LymphodemaTotalWorms,
-                                           LymphodemaShape)
-              << "\n";
+      outfile << census.lymphodema[j] << "\n";
     }
   }
-
-  outfile.close();
 }
 
 void Scenario::InitNTDMCData(int rep, std::string folder) {
   // get mf prevalence
-  struct stat buffer;
-
-  std::string fname;
-  std::string fname2;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-  fname = folder + "/NTDMC_scen" + fol_n + "/" + name + "/NTDMC_scen" + name +
-          "_rep_" + rep1 + ".csv";
-  fname2 = folder + "/NTDMC_scen" + fol_n + "/" + name;
-  if (stat(fname2.c_str(), &buffer) != 0) {
-    fs::create_directories(fname2);
-  }
-
-  std::ofstream outfile;
-  outfile.open(fname);
+  std::ostream &outfile = outputFile(NTDMCOutput, rep, folder, true);
 
   if (rep == 0) {
     outfile << "espen_loc"
@@ -874,7 +799,6 @@ void Scenario::InitNTDMCData(int rep, std::string folder) {
     outfile << "draw_0"
             << "\n";
   }
-  outfile.close();
 }
 
 void Scenario::writeMDADataAllTreated(int t, int roundNumber,
@@ -885,22 +809,8 @@ void Scenario::writeMDADataAllTreated(int t, int roundNumber,
 
   assert(numHostsByAge.size() == maxAge);
   assert(numTreatedByAge.size() == maxAge);
-  std::ofstream outfile;
-  std::string fname;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/IHME_scen" + name +
-          "_rep_" + rep1 + ".csv";
   int year = t / 12 + 2000;
-
-  outfile.open(fname, std::ios::app);
-  if (!outfile.is_open()) {
-    std::cerr << "Error: Unable to open file " << fname << " for writing."
-              << std::endl;
-    return; // Or handle the error appropriately
-  }
+  std::ostream &outfile = outputFile(IHMEOutput, rep, folder);
 
   // we output the number of people who were given doses of drugs, so we can
   // keep track of the distribution across age groups and costs
@@ -929,28 +839,12 @@ void Scenario::writeMDADataAllTreated(int t, int roundNumber,
       outfile << numHostsByAge[j] << "\n";
     }
   }
-
-  outfile.close();
 }
 
 void Scenario::writePreTAS(int t, int *numSurvey, int maxAge, int rep,
                            std::string folder) {
-  std::ofstream outfile;
-  std::string fname;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/PreTAS_scen" + name +
-          "_rep_" + rep1 + ".csv";
   int year = t / 12 + 2000;
-
-  outfile.open(fname, std::ios::app);
-  if (!outfile.is_open()) {
-    std::cerr << "Error: Unable to open file " << fname << " for writing."
-              << std::endl;
-    return; // Or handle the error appropriately
-  }
+  std::ostream &outfile = outputFile(PreTASOutput, rep, folder);
   if (rep == 0) {
     for (int j = 0; j < maxAge; j++) {
       outfile << name << "," << year << "," << j << "," << j + 1 << ","
@@ -961,28 +855,12 @@ void Scenario::writePreTAS(int t, int *numSurvey, int maxAge, int rep,
       outfile << numSurvey[j] << "\n";
     }
   }
-
-  outfile.close();
 }
 
 void Scenario::writeTAS(int t, int *numSurvey, int maxAge, int rep,
                         std::string folder) {
-  std::ofstream outfile;
-  std::string fname;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/TAS_scen" + name +
-          "_rep_" + rep1 + ".csv";
   int year = t / 12 + 2000;
-
-  outfile.open(fname, std::ios::app);
-  if (!outfile.is_open()) {
-    std::cerr << "Error: Unable to open file " << fname << " for writing."
-              << std::endl;
-    return; // Or handle the error appropriately
-  }
+  std::ostream &outfile = outputFile(TASOutput, rep, folder);
   if (rep == 0) {
     for (int j = 0; j < maxAge; j++) {
       outfile << name << "," << year << "," << j << "," << j + 1 << ","
@@ -993,35 +871,23 @@ void Scenario::writeTAS(int t, int *numSurvey, int maxAge, int rep,
       outfile << numSurvey[j] << "\n";
     }
   }
-
-  outfile.close();
 }
 
 void Scenario::writeEmptySurvey(int year, int maxAge, int rep,
                                 std::string surveyType, std::string folder) {
-  std::ofstream outfile;
-  std::string fname;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-
+  OutputStream stream;
   if (surveyType == "PreTAS survey") {
-    fname = folder + "/IHME_scen" + fol_n + "/" + name + "/PreTAS_scen" + name +
-            "_rep_" + rep1 + ".csv";
-  }
-  if (surveyType == "TAS survey") {
-    fname = folder + "/IHME_scen" + fol_n + "/" + name + "/TAS_scen" + name +
-            "_rep_" + rep1 + ".csv";
+    stream = PreTASOutput;
+  } else if (surveyType == "TAS survey") {
+    stream = TASOutput;
+  } else {
+    std::cerr << "Error in Scenario::writeEmptySurvey. Unknown survey type "
+              << surveyType << std::endl;
+    return;
   }
 
   // int year = t/12 + 2000;
-
-  outfile.open(fname, std::ios::app);
-  if (!outfile.is_open()) {
-    std::cerr << "Error: Unable to open file " << fname << " for writing."
-              << std::endl;
-    return; // Or handle the error appropriately
-  }
+  std::ostream &outfile = outputFile(stream, rep, folder);
   if (rep == 0) {
     for (int j = 0; j < maxAge; j++) {
       outfile << name << "," << year << "," << j << "," << j + 1 << ","
@@ -1032,24 +898,13 @@ void Scenario::writeEmptySurvey(int year, int maxAge, int rep,
       outfile << 0 << "\n";
     }
   }
-
-  outfile.close();
 }
 
 void Scenario::writeSurveyByAge(Population &popln, int t, int preTAS_Pass,
                                 int TAS_Pass, int rep, std::string folder) {
   // get mf prevalence
-  std::ofstream outfile;
-
-  std::string fname;
-  std::string rep1 = std::to_string(rep);
-  std::size_t first_ = name.find("_");
-  std::string fol_n = name.substr(0, first_);
-  fname = folder + "/IHME_scen" + fol_n + "/" + name + "/IHME_scen" + name +
-          "_rep_" + rep1 + ".csv";
   int year = t / 12 + 2000;
-
-  outfile.open(fname, std::ios::app);
+  std::ostream &outfile = outputFile(IHMEOutput, rep, folder);
 
   if (rep == 0) {
     outfile << name << "," << year << ","
@@ -1086,8 +941,115 @@ void Scenario::writeSurveyByAge(Population &popln, int t, int preTAS_Pass,
     outfile << preTAS_Pass << "\n";
     outfile << TAS_Pass << "\n";
   }
+}
+
+std::ostream &Scenario::outputFile(OutputStream stream, int rep,
+                                  std::string folder, bool truncate) {
+
+  // one file per replicate and stream, opened on first use and kept open until
+  // closeOutputFiles. Replicates run on different threads, so the map is
+  // locked, but a given file is only written by its replicate's thread
 
-  outfile.close();
+  std::lock_guard<std::mutex> lock(*sinksMutex);
+  std::unique_ptr<OutputSink> &sink = outputSinks[{rep, stream}];
+  if (sink && !truncate)
+    return drawsFolder.empty() ? (std::ostream &)sink->file : sink->text;
+
+  std::size_t first_ = name.find("_");
+  std::string fol_n = name.substr(0, first_);
+  std::string rep1 = std::to_string(rep);
+  std::string fname;
+  switch (stream) {
+  case IHMEOutput:
+    fname = folder + "/IHME_scen" + fol_n + "/" + name + "/IHME_scen" + name +
+            "_rep_" + rep1 + ".csv";
+    break;
+  case PreTASOutput:
+    fname = folder + "/IHME_scen" + fol_n + "/" + name + "/PreTAS_scen" + name +
+            "_rep_" + rep1 + ".csv";
+    break;
+  case TASOutput:
+    fname = folder + "/IHME_scen" + fol_n + "/" + name + "/TAS_scen" + name +
+            "_rep_" + rep1 + ".csv";
+    break;
+  case NTDMCOutput:
+    fname = folder + "/NTDMC_scen" + fol_n + "/" + name + "/NTDMC_scen" + name +
+            "_rep_" + rep1 + ".csv";
+    break;
+  }
+
+  sink = std::make_unique<OutputSink>();
+  if (!drawsFolder.empty())
+    return sink->text;
+
+  fs::create_directories(fs::path(fname).parent_path());
+
+  // the buffer must be in place before the file is opened
+  sink->buffer.resize(outputBufferSize);
+  sink->file.rdbuf()->pubsetbuf(sink->buffer.data(), sink->buffer.size());
+  sink->file.open(fname, truncate ? std::ios::out : std::ios::app);
+  if (!sink->file.is_open())
+    std::cerr << "Error: Unable to open file " << fname << " for writing."
+              << std::endl;
+  return sink->file;
+}
+
+void Scenario::closeOutputFiles(int rep) {
+
+  // flush and close this replicate's files, or keep its text for the draws
+  std::lock_guard<std::mutex> lock(*sinksMutex);
+  for (auto it = outputSinks.begin(); it != outputSinks.end();) {
+    if (it->first.first == rep) {
+      if (!drawsFolder.empty()) {
+        int stream = it->first.second;
+        if ((int)drawsCsv.size() <= stream)
+          drawsCsv.resize(stream + 1);
+        if ((int)drawsCsv[stream].size() <= rep)
+          drawsCsv[stream].resize(rep + 1);
+        drawsCsv[stream][rep] = it->second->text.str();
+      }
+      it = outputSinks.erase(it);
+    } else
+      ++it;
+  }
+}
+
+void Scenario::writeDraws() {
+
+  // the files run/combine-lf-outputs.py would make from the csv files, named
+  // and placed as run/run-lf-model.bash places them
+  if (drawsFolder.empty() || drawsCsv.empty())
+    return;
+  drawsCsv.resize(NTDMCOutput + 1);
+
+  std::size_t first_ = name.find("_");
+  std::string scen = name.substr(0, first_);
+  std::string iu = name.substr(first_ + 1);
+  iu = iu.substr(0, iu.find("_"));
+  std::string dir = drawsFolder + "/lf/scenario_" + scen + "/" +
+                    iu.substr(0, 3) + "/" + iu;
+
+  const std::vector<std::vector<const ReplicateCsv *>> parts = {
+      {&drawsCsv[IHMEOutput], &drawsCsv[PreTASOutput], &drawsCsv[TASOutput]},
+      {&drawsCsv[NTDMCOutput]}};
+  const std::vector<std::string> institutes = {"ihme", "ntdmc"};
+
+  for (unsigned i = 0; i < parts.size(); i++) {
+    if (parts[i][0]->empty())
+      continue;
+    fs::create_directories(dir);
+    std::string fname = dir + "/" + institutes[i] + "-" + iu +
+                        "-lf-scenario_" + scen + "-" +
+                        std::to_string(parts[i][0]->size()) + ".csv";
+    std::ofstream outfile(fname);
+    if (!outfile.is_open()) {
+      std::cout << "Error in Scenario::writeDraws. Cannot write file " << fname
+                << std::endl;
+      exit(1);
+    }
+    ::writeDraws(outfile, parts[i]);
+  }
+  drawsCsv.clear();
 }
 
 std::string Scenario::getName() {
@@ -10,6 +10,7 @@
 #define Scenario_hpp
 
 #include "BedNetEvent.hpp"
+#include "Draws.hpp"
 #include "ImportationRateEvent.hpp"
 #include "MDAEvent.hpp"
 #include "Population.hpp"
@@ -18,12 +19,37 @@
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <vector>
 
+class AgeCensus;
 class Output;
 class Population;
 
+// text of one replicate's rows in each of a scenario's summary files
+typedef struct {
+
+  std::string IC, MF, WC;
+  std::string extraIC, extraMF, extraWC;
+  std::vector<std::string> pop;
+
+} ReplicateResults;
+
+// a per-replicate output file, held open while the replicate runs. The large
+// buffer means records reach the file system in a few big writes. When writing
+// draws, the records are kept in text instead until the replicate ends
+typedef struct {
+
+  std::vector<char> buffer;
+  std::ofstream file;
+  std::ostringstream text;
+
+} OutputSink;
+
 // class to represent a single scenario
 
 class Scenario {
@@ -118,6 +144,11 @@ public:
       exit(1);
     }
 
+    // months with no event of their own keep the one before
+    for (int month = 1; month < numMonths; month++)
+      if (!bedNetCoverage[month])
+        bedNetCoverage[month] = bedNetCoverage[month - 1];
+
     for (unsigned month = 0; month < aImpFactors.size(); month++) {
 
       int aImpMonth = aImpFactors[month].getMonth();
@@ -159,11 +190,12 @@ public:
   bool requiresWC() const;
 
   void openFileandPrintHeadings(std::string region, Output &results);
-  void printColumnTitles(std::ofstream &of, Output &results,
+  void printColumnTitles(std::ostream &of, Output &results,
                          bool extra = false) const;
   void printResults(int repnum, Output &results, Population &popln);
-  void printReplicate(std::ofstream &of, Output &results, int repnum,
+  void printReplicate(std::ostream &of, Output &results, int repnum,
                       Population &popln) const;
+  void writeResults(int repnum, const ReplicateResults &res);
   void closeFile();
   std::string getName();
 
@@ -171,14 +203,14 @@ public:
   void InitNTDMCData(int rep, std::string folder);
   void InitPreTASData(int rep, std::string folder);
   void InitTASData(int rep, std::string folder);
-  void writePrevByAge(Population &popln, int t, int rep, std::string folder);
+  void writePrevByAge(const AgeCensus &census, int t, int rep,
+                      std::string folder);
   void writeRoadmapTarget(Population &popln, int t, int rep, int DoMDA,
                           int TAS_Pass, int neededTASPass, std::string folder);
-  void writeNumberByAge(Population &popln, int t, int rep, std::string folder,
-                        std::string surveyType);
-  void writeSequelaeByAge(Population &popln, int t, int LymphodemaTotalWorms,
-                          double LymphodemaShape, int HydroceleTotalWorms,
-                          double HydroceleShape, int rep, std::string folder);
+  void writeNumberByAge(const std::vector<int> &numberByAge, int t, int rep,
+                        std::string folder, std::string surveyType);
+  void writeSequelaeByAge(const AgeCensus &census, int t, int rep,
+                          std::string folder);
   void writeMDADataAllTreated(int t, int roundNumber,
                               const std::vector<int> &numTreatedByAge,
                               const std::vector<int> &numHostsByAge, int maxAge,
@@ -190,10 +222,21 @@ public:
                         int rep, std::string folder);
   void writeEmptySurvey(int year, int maxAge, int rep, std::string surveyType,
                         std::string folder);
-  void writeIncidence(int t, int *numSurvey, int maxAge, int rep,
+  void writeIncidence(int t, const std::vector<int> &incidence, int rep,
                       std::string folder);
+  // flush and close the per-replicate csv files, at the end of the replicate
+  void closeOutputFiles(int rep);
+  // keep the per-replicate csv output in memory and, once all replicates are
+  // done, write it to folder as one wide draws file per output type
+  void setDrawsFolder(std::string folder) { drawsFolder = folder; }
+  void writeDraws();
 
 protected:
+  // the per-replicate csv files written while the scenario runs
+  enum OutputStream { IHMEOutput, PreTASOutput, TASOutput, NTDMCOutput };
+  std::ostream &outputFile(OutputStream stream, int rep, std::string folder,
+                           bool truncate = false);
+
   int startMonth;
 
   std::vector<BedNetEvent> bedNets;
@@ -212,8 +255,22 @@ protected:
   std::ofstream myFileExtraMF, myFileExtraIC, myFileExtraWC;
 
   std::ofstream *popFiles = NULL;
+
+  // replicates finished ahead of nextRepToWrite wait here to be written
+  std::map<int, ReplicateResults> pendingResults;
+  int nextRepToWrite = 0;
+  std::unique_ptr<std::mutex> resultsMutex = std::make_unique<std::mutex>();
   const std::vector<int> popAgeRanges = {5};
 
+  // open per-replicate csv files, keyed by replicate and stream
+  static const std::size_t outputBufferSize = 1 << 18;
+  std::map<std::pair<int, int>, std::unique_ptr<OutputSink>> outputSinks;
+  std::unique_ptr<std::mutex> sinksMutex = std::make_unique<std::mutex>();
+
+  // for draws output, each stream's csv text for every replicate
+  std::string drawsFolder;
+  std::vector<ReplicateCsv> drawsCsv;
+
   int minAgeExtra;
   int maxAgeExtra;
   bool requiresExtra;
@@ -353,3 +353,27 @@ void ScenariosList::closeFiles() {
   for (unsigned s = 0; s < scenarios.size(); s++)
     scenarios[s].closeFile();
 }
+
+int ScenariosList::getParent(int s) const {
+
+  // the latest earlier scenario to save this month, whose state a sequential
+  // run would reset to
+  int start = scenarios[s].getStartMonth();
+  for (int p = s - 1; p >= 0; p--)
+    for (int y = 0; y < scenarios[p].getNumMonthsToSave(); y++)
+      if (scenarios[p].getMonthToSave(y) == start)
+        return p;
+  return -1;
+}
+
+void ScenariosList::setDrawsOutput(std::string folder) {
+
+  for (unsigned s = 0; s < scenarios.size(); s++)
+    scenarios[s].setDrawsFolder(folder);
+}
+
+void ScenariosList::writeDraws() {
+
+  for (unsigned s = 0; s < scenarios.size(); s++)
+    scenarios[s].writeDraws();
+}
@@ -38,11 +38,19 @@ public:
                        const std::string opDir);
   void openFilesandPrintHeadings(int index, Output &results);
   void closeFiles();
+  // write the replicates' csv output as wide draws files in folder, see
+  // Scenario::writeDraws
+  void setDrawsOutput(std::string folder);
+  void writeDraws();
 
   const Scenario &getScenario(int num) const;
+  // the scenario that saves the month scenario s starts from, or -1 if s
+  // starts from the end of the burn-in
+  int getParent(int s) const;
   unsigned long getNumScenarios() const;
 
   std::string getName() const { return name; }
+  std::string getOutputDir() const { return outputDir; }
 
   int getBaseYear() const { return baseYear; }
   int getNumYears() const { return numYears; }
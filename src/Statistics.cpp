@@ -7,6 +7,9 @@
 //
 
 #include "Statistics.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
 #include <vector>
 
 double Statistics::gamma_dist(double k) {
@@ -14,6 +17,8 @@ double Statistics::gamma_dist(double k) {
   // used to generate host bite risk . k is shape parameter, 1/k = rate
   // parameter
 
+  if (pairing != unpaired)
+    return gsl_cdf_gamma_Pinv(pairedUniform(), k, 1 / k);
   return gsl_ran_gamma(rando, k, 1 / k);
 }
 
@@ -21,7 +26,9 @@ int Statistics::poisson_dist(double rate) {
 
   // used to calculate  worm births and deaths in host
 
-  if (rate < 10E3)
+  if (rate < 10E3 && pairing != unpaired)
+    return poissonInverse(rate, pairedUniform());
+  else if (rate < 10E3)
     return gsl_ran_poisson(rando, rate);
   else
     return (int)normal_dist(rate, sqrt(rate));
@@ -33,7 +40,8 @@ double Statistics::uniform_dist() {
   // infection and when they use a bednet Also used in paramter sampling,
   // calculating prvelance
 
-  return gsl_ran_flat(rando, 0, 1);
+  double u = gsl_ran_flat(rando, 0, 1);
+  return pairing == secondOfPair ? 1 - u : u;
 }
 
 double Statistics::normal_dist(double mu, double sigma) {
@@ -41,6 +49,8 @@ double Statistics::normal_dist(double mu, double sigma) {
   // sample from distribution of mean mu and SD sigma
   // used for generatring bednet usage
 
+  if (pairing != unpaired)
+    return mu + sigma * gsl_cdf_ugaussian_Pinv(pairedUniform());
   return mu + gsl_ran_gaussian(rando, sigma);
 }
 
@@ -48,18 +58,24 @@ double Statistics::unit_normal_dist() {
 
   // as above but sigma=1
 
+  if (pairing != unpaired)
+    return gsl_cdf_ugaussian_Pinv(pairedUniform());
   return gsl_ran_ugaussian(rando);
 }
 
 double Statistics::exp_dist(double mu) {
 
   // exponential dist with mean mu
+  if (pairing != unpaired)
+    return -mu * log(pairedUniform());
   return gsl_ran_exponential(rando, mu);
 }
 
 double Statistics::beta_dist(double alpha, double beta) {
 
   // exponential dist with mean mu
+  if (pairing != unpaired)
+    return gsl_cdf_beta_Pinv(pairedUniform(), alpha, beta);
   return gsl_ran_beta(rando, alpha, beta);
 }
 
@@ -81,6 +97,82 @@ std::string Statistics::selectDistribType() {
     return std::string("exp");
 }
 
-void Statistics::shuffle_indices(std::vector<int> &indices) {
-  gsl_ran_shuffle(rando, indices.data(), indices.size(), sizeof(int));
+unsigned long int Statistics::uniform_int(unsigned long int n) {
+
+  if (pairing == unpaired)
+    return gsl_rng_uniform_int(rando, n);
+  unsigned long int k =
+      std::min(n - 1, (unsigned long int)(gsl_rng_uniform(rando) * n));
+  return pairing == secondOfPair ? n - 1 - k : k;
+}
+
+double Statistics::pairedUniform() {
+
+  double u = gsl_rng_uniform_pos(rando);
+  return pairing == secondOfPair ? 1 - u : u;
+}
+
+int Statistics::poissonInverse(double rate, double u) {
+
+  // the smallest k with P(X <= k) >= u, walking from the mode, where the
+  // probabilities are largest, so it takes about sqrt(rate) steps
+  if (rate <= 0)
+    return 0;
+  int mode = int(rate);
+  double pMode = exp(-rate + mode * log(rate) - lgamma(mode + 1.0));
+
+  // P(X <= mode), summing down until the terms no longer count
+  double cdf = pMode;
+  double p = pMode;
+  for (int j = mode; j > 0 && p > cdf * 1e-17; j--) {
+    p *= j / rate;
+    cdf += p;
+  }
+
+  // cdf = P(X <= k) and p = P(X = k) as k walks down or up
+  int k = mode;
+  p = pMode;
+  if (u <= cdf) {
+    while (k > 0 && u <= cdf - p) {
+      cdf -= p;
+      p *= k / rate;
+      k--;
+    }
+  } else {
+    while (u > cdf && p > 0) {
+      k++;
+      p *= rate / k;
+      cdf += p;
+    }
+  }
+  return k;
+}
+
+std::vector<char> Statistics::getState() const {
+
+  const char *state = static_cast<const char *>(gsl_rng_state(rando));
+  return std::vector<char>(state, state + gsl_rng_size(rando));
+}
+
+void Statistics::setState(const std::vector<char> &state) {
+
+  if (state.size() != gsl_rng_size(rando)) {
+    std::cout << "Error in Statistics::setState. Saved state is for a "
+                 "different type of generator."
+              << std::endl;
+    exit(1);
+  }
+  memcpy(gsl_rng_state(rando), state.data(), state.size());
 }
+
+unsigned long int Statistics::streamSeed(unsigned long int seed,
+                                         unsigned stream) {
+
+  // splitmix64, so that nearby seeds and streams give unrelated seeds
+  std::uint64_t z = std::uint64_t(seed) + (stream + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return (unsigned long int)(z ^ (z >> 31));
+}
+
+std::string Statistics::getGeneratorName() const { return gsl_rng_name(rando); }
@@ -16,7 +16,8 @@
 #include <vector>
 
 // Container class for gsl random number functions required by many other
-// classes
+// classes. Each Population owns one, so every replicate (and thread) draws
+// from its own stream
 class Statistics {
 public:
   Statistics() {
@@ -25,13 +26,45 @@ public:
         gsl_rng_default); // rando is a pointer to the random number generator
   }
 
+  // copies continue from the same point in the stream as the original
+  Statistics(const Statistics &other) : pairing(other.pairing) {
+    rando = gsl_rng_clone(other.rando);
+  }
+
+  Statistics &operator=(const Statistics &other) {
+    if (this != &other) {
+      gsl_rng_memcpy(rando, other.rando);
+      pairing = other.pairing;
+    }
+    return *this;
+  }
+
   ~Statistics() { gsl_rng_free(rando); }
 
   void set_seed(unsigned long int seed) {
     gsl_rng_set(rando, seed); // set the seed
   }
 
-  void shuffle_indices(std::vector<int> &indices);
+  // seed for a separate stream numbered stream, derived from seed. Streams
+  // forked from one replicate then don't depend on the order they run in
+  static unsigned long int streamSeed(unsigned long int seed, unsigned stream);
+
+  // raw generator state, so a stream can be saved and later resumed
+  std::vector<char> getState() const;
+  void setState(const std::vector<char> &state);
+  std::string getGeneratorName() const;
+
+  // antithetic pairs of replicates. Both replicates of a pair draw every
+  // value by inverting a single uniform u, so that from the same seed they
+  // stay in step, and the second inverts 1 - u where the first inverts u.
+  // Values have the same distributions as unpaired, but are not the same
+  // values, except that uniform_dist is unchanged for the first of a pair
+  enum Pairing { unpaired, firstOfPair, secondOfPair };
+  void setPairing(Pairing p) { pairing = p; }
+  Pairing getPairing() const { return pairing; }
+
+  // uniform on 0 ... n-1
+  unsigned long int uniform_int(unsigned long int n);
   double gamma_dist(double k);
   double normal_dist(double mean, double sd);
   double unit_normal_dist();
@@ -43,7 +76,12 @@ public:
   std::string selectDistribType();
 
 private:
+  // u on (0, 1), or 1 - u for the second of a pair
+  double pairedUniform();
+  static int poissonInverse(double rate, double u);
+
   gsl_rng *rando;
+  Pairing pairing = unpaired;
 };
 
 #endif /* Statistics_hpp */
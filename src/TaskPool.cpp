@@ -0,0 +1,50 @@
+//
+//  TaskPool.cpp
+//  transfil
+//
+//  A fixed set of worker threads running tasks that may add further tasks.
+//
+
+#include "TaskPool.hpp"
+#include <thread>
+
+void TaskPool::add(Task task) {
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+  changed.notify_one();
+}
+
+void TaskPool::run() {
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads; i++)
+    workers.emplace_back(&TaskPool::work, this, i);
+  work(0);
+  for (std::thread &w : workers)
+    w.join();
+}
+
+void TaskPool::work(int worker) {
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+
+    // done when nothing is queued and no running task can add more
+    changed.wait(lock, [this] { return !tasks.empty() || running == 0; });
+    if (tasks.empty())
+      break;
+
+    Task task = std::move(tasks.back());
+    tasks.pop_back();
+    running++;
+    lock.unlock();
+    task(worker);
+    lock.lock();
+    running--;
+    if (running == 0 && tasks.empty())
+      changed.notify_all();
+  }
+}
@@ -0,0 +1,45 @@
+//
+//  TaskPool.hpp
+//  transfil
+//
+//  A fixed set of worker threads running tasks that may add further tasks.
+//
+
+#ifndef TaskPool_hpp
+#define TaskPool_hpp
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Tasks are taken newest first, so the tasks a running task adds (eg the
+// scenarios branching from it) run before older ones (eg the next replicate).
+// That keeps the number of branches waiting to run, and the state they hold,
+// down to about one tree per thread.
+
+class TaskPool {
+
+public:
+  // a task is passed the index of the worker running it, 0 to threads-1
+  typedef std::function<void(int worker)> Task;
+
+  TaskPool(int threads) : threads(threads) {}
+
+  // may be called from within a running task
+  void add(Task task);
+  // run tasks on threads workers, one of them the calling thread, until all
+  // tasks, including those added while running, are done
+  void run();
+
+private:
+  void work(int worker);
+
+  int threads;
+  std::vector<Task> tasks;
+  int running = 0;
+  std::mutex mutex;
+  std::condition_variable changed;
+};
+
+#endif /* TaskPool_hpp */
@@ -16,7 +16,6 @@
 #include "Worm.hpp"
 #include "tinyxml.h"
 
-extern Statistics stats;
 
 Vector::Vector(TiXmlElement *xmlParameters) {
 
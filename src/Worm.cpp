@@ -12,7 +12,6 @@
 #include <fstream>
 #include <iostream>
 
-extern Statistics stats;
 
 Worm::Worm(TiXmlElement *xmlParameters) {
 
@@ -62,6 +61,48 @@ Worm::Worm(TiXmlElement *xmlParameters) {
                 << std::endl;
   }
 
+  // the drugs built in. The efficacy of IA and IA2 are in line with the
+  // original and the more pessimistic parameters from the business case work,
+  // that of moxidectin (MA1) with the latest parameters from it
+  regimens["da"] = {0.55, 1, 9};
+  regimens["ida"] = {0.55, 0.99, 9};
+  regimens["aa"] = {0.35, 0, 0};
+  regimens["ia"] = {0.35, 0.99, 9};
+  regimens["ia2"] = {0.32, 0.99, 6};
+  regimens["ds"] = {0.59, 0.86, 10};
+  regimens["ma1"] = {0.82, 1, 18};
+  regimens["ma2"] = {0.9, 1, 18};
+
+  // more, or changes to these, eg
+  // <drug name="da" wormsKilled="0.55" mfKilled="1" fecRed="9" />
+  for (TiXmlElement *xmlDrug = xmlWorm->FirstChildElement("drug");
+       xmlDrug != NULL; xmlDrug = xmlDrug->NextSiblingElement("drug")) {
+
+    DrugRegimen regimen;
+    const char *name = xmlDrug->Attribute("name");
+    if (name == NULL ||
+        xmlDrug->QueryDoubleAttribute("wormsKilled", &regimen.wormsKilled) !=
+            TIXML_SUCCESS ||
+        xmlDrug->QueryDoubleAttribute("mfKilled", &regimen.mfKilled) !=
+            TIXML_SUCCESS ||
+        xmlDrug->QueryDoubleAttribute("fecRed", &regimen.fecRed) !=
+            TIXML_SUCCESS) {
+      std::cout << "Error in Worm::Worm. A drug needs a name, wormsKilled, "
+                   "mfKilled and fecRed."
+                << std::endl;
+      exit(1);
+    }
+    if (regimen.wormsKilled < 0 || regimen.wormsKilled > 1 ||
+        regimen.mfKilled < 0 || regimen.mfKilled > 1 || regimen.fecRed < 0) {
+      std::cout << "Error in Worm::Worm. Drug " << name
+                << " must kill proportions of worms and mf between 0 and 1 "
+                   "and have fecRed >= 0."
+                << std::endl;
+      exit(1);
+    }
+    regimens[name] = regimen;
+  }
+
   if (gotAll < 7) {
     std::cout << "Error in Worm::Worm. File  does not contain all the required "
                  "parameters."
@@ -111,88 +152,19 @@ void Worm::reset(double wProp) {
   wPropMDA = wProp;
 }
 
-int Worm::wormsTreated(int W, std::string type) {
-
-  double propWormsKilled;
-
-  if (type == "da") {
-    propWormsKilled = (wPropMDA >= 0) ? wPropMDA : 0.55;
-    fecRed = 9;
-  } else if (type == "ida") {
-    propWormsKilled = (wPropMDA >= 0) ? wPropMDA : 0.55;
-    fecRed = 9; // no temporary sterilization
-  } else if (type == "aa") {
-    propWormsKilled = (wPropMDA >= 0) ? wPropMDA : 0.35;
-    fecRed = 0;
-  } else if (type == "ia") {
-    // efficacy of using IA in line with original parameters from the business
-    // case work
-    propWormsKilled = (wPropMDA >= 0) ? wPropMDA : 0.35;
-    fecRed = 9;
-  } else if (type == "ia2") {
-    // efficacy of using IA in line with more pessimistic parameters from the
-    // business case work
-    propWormsKilled = (wPropMDA >= 0) ? wPropMDA : 0.32;
-    fecRed = 6;
-  } else if (type == "ds") {
-    propWormsKilled = (wPropMDA >= 0) ? wPropMDA : 0.59;
-    fecRed = 10;
-  } else if (type == "ma1") {
-    // efficacy of using moxidectin in line with the latest parameters from the
-    // business case work
-    propWormsKilled = (wPropMDA >= 0) ? wPropMDA : 0.82;
-    fecRed = 18;
-  } else if (type == "ma2") {
-    propWormsKilled = (wPropMDA >= 0) ? wPropMDA : 0.9;
-    fecRed = 18;
-  } else {
-    std::cout << " Error in Worm::wormsTreated. Unknown treatment type " << type
-              << std::endl;
-    exit(1);
-  }
-
-  return int((1 - propWormsKilled) * double(W));
-}
+DrugRegimen Worm::getRegimen(std::string type) const {
 
-double Worm::mfTreated(double M, std::string type) {
-
-  if (type == "da") {
-    mfPropMDA = 1 - 1;
-    fecRed = 9;
-  } else if (type == "ida") {
-    mfPropMDA = 1 - 0.99;
-    fecRed = 9; // no temporary sterilization
-  } else if (type == "aa") {
-    mfPropMDA = 1 - 0;
-    fecRed = 0;
-  } else if (type == "ia") {
-    // efficacy of using IA in line with original parameters from the business
-    // case work
-    mfPropMDA = 1 - 0.99;
-    fecRed = 9;
-  } else if (type == "ia2") {
-    // efficacy of using IA in line with more pessimistic parameters from the
-    // business case work
-    mfPropMDA = 1 - 0.99;
-    fecRed = 6;
-  } else if (type == "ds") {
-    mfPropMDA = 1 - 0.86;
-    fecRed = 10;
-  } else if (type == "ma1") {
-    // efficacy of using moxidectin in line with the latest parameters from the
-    // business case work
-    mfPropMDA = 1 - 1;
-    fecRed = 18;
-  } else if (type == "ma2") {
-    mfPropMDA = 1 - 1;
-    fecRed = 18;
-  } else {
-    std::cout << " Error in Worm::wormsTreated. Unknown treatment type " << type
+  std::map<std::string, DrugRegimen>::const_iterator it = regimens.find(type);
+  if (it == regimens.end()) {
+    std::cout << " Error in Worm::getRegimen. Unknown treatment type " << type
               << std::endl;
     exit(1);
   }
 
-  return M * mfPropMDA;
+  DrugRegimen regimen = it->second;
+  if (wPropMDA >= 0)
+    regimen.wormsKilled = wPropMDA;
+  return regimen;
 }
 
 std::vector<double> Worm::printRandomVariableValues() const {
@@ -8,10 +8,20 @@
 
 #ifndef Worm_hpp
 #define Worm_hpp
+#include <map>
 #include <string>
 #include <vector>
 class TiXmlElement;
 
+// what a drug regimen does to each host treated
+typedef struct {
+
+  double wormsKilled; // proportion of adult worms killed
+  double mfKilled;    // proportion of mf killed
+  double fecRed;      // WF can't produce more mf for this many months
+
+} DrugRegimen;
+
 class Worm {
 
   // class tomodel worm dynamics in host and vector
@@ -24,8 +34,11 @@ public:
   double repRate(unsigned monthsSinceTreated, int femaleWorms,
                  int maleWorms) const;
   double getPropLeavingVectorPerBite() const;
-  int wormsTreated(int W, std::string type);
-  double mfTreated(double M, std::string type);
+  // the regimen of MDA type, with this replicate's proportion of worms killed
+  // if it has one
+  DrugRegimen getRegimen(std::string type) const;
+  // the regimen given by the latest MDA
+  void setTreatedWith(const DrugRegimen &regimen) { fecRed = regimen.fecRed; }
   void reset(double wProp);
   std::vector<double> printRandomVariableValues() const;
   std::vector<std::string> printRandomVariableNames() const;
@@ -41,9 +54,11 @@ private:
              // to num females as long as at least one male present. Otherwise,
              // larger values make it more likely rate will be lower and
              // proportional to num males
-  double mfPropMDA; // proportion mf killed by drugs
-  double wPropMDA;  // proportion worms killed by drugs
-  double fecRed;    // WF can't produce more mf for this many months after MDA
+  double wPropMDA;   // proportion worms killed by drugs
+  double fecRed = 0; // WF can't produce more mf for this many months after MDA
+
+  // MDA types, those built in and any given in the ParamList
+  std::map<std::string, DrugRegimen> regimens;
 };
 
 #endif /* Worm_hpp */
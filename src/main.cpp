@@ -1,15 +1,21 @@
 // pointer to classes example
 
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string.h>
 #include <string>
 #include <sys/time.h>
 
+#include "BurnInCache.hpp"
 #include "Model.hpp"
 #include "Population.hpp"
 #include "ScenariosList.hpp"
 #include "Statistics.hpp"
+#include "TaskPool.hpp"
 #include "Vector.hpp"
 #include "Worm.hpp"
 #include "tinyxml.h"
@@ -38,11 +44,168 @@
  */
 
 bool _DEBUG = false;
-Statistics stats;
 
 // Exclude the test when building the `model` library
 // used for testing (as CTest provides the main method)
 #ifndef DISABLE_MAIN_METHOD
+namespace fs = std::filesystem;
+
+// the inputs and options of one run of the model
+typedef struct {
+
+  int index;
+  int replicates;
+  double dt;
+  std::string popFile;
+  std::string randParamsfile;
+  std::string scenariosFile;
+  std::string opDir;
+  std::string RandomSeedFile;
+  std::string CoverageReductionFile;
+  std::string drawsDir;  // if set, write combined draws files here
+  std::string burnInDir; // if set, save and reuse burn-ins here
+  double equilibriumTolerance; // if set, stop burn-in at equilibrium
+  int minBurnInYears;
+
+  // whether the endgame output will be done and whether the reduction in
+  // importation rate should be done via the xml file rather than impact of
+  // MDA on the prevalence
+  int outputEndgame;
+  int outputEndgameDate;
+  bool outputNTDMC;
+  int outputNTDMCDate;
+  int reduceImpViaXml;
+  int threads;              // number of replicates to run at once
+  int forkScenarios;        // run scenarios of a replicate at the same time
+  int commonRandomNumbers;  // scenarios from the same month share draws
+  int expectedPrevalence;   // output expected rather than sampled prevalence
+  int antitheticPairs;      // run replicates in antithetic pairs
+  double stoppingHalfWidth; // if set, stop once the headlines are this precise
+  int stoppingYear;         // year of the mf prevalence headline, 0 for last
+
+} RunOptions;
+
+static void runModel(const RunOptions &run, bool showProgress) {
+
+  // Read the inputs
+
+  TiXmlDocument scenariosDoc(run.scenariosFile);
+  if (!scenariosDoc.LoadFile()) {
+    std::cout << "Error: cannot read file " << run.scenariosFile << std::endl;
+    exit(1);
+  }
+  TiXmlElement *xmlModel = scenariosDoc.RootElement(); //<Model> element
+  if (xmlModel == NULL) {
+    std::cout << "Error: Invalid file " << run.scenariosFile
+              << ". Does not contain the <Model> root element" << std::endl;
+    exit(1);
+  }
+
+  TiXmlElement *xmlParameters = xmlModel->FirstChildElement("ParamList");
+  if (xmlParameters == NULL) {
+    std::cout << "Error: Cannot find parameter values in file "
+              << run.scenariosFile << std::endl;
+    exit(1);
+  }
+
+  // Create the Vector, Worm and Host population objects
+  Vector vectors(xmlParameters);
+  Worm worms(xmlParameters);
+  Population hostPopulation(xmlParameters);
+
+  hostPopulation.loadPopulationSize(run.popFile);
+  hostPopulation.setExpectedPrevalence(run.expectedPrevalence != 0);
+
+  // Create Scenarios
+  TiXmlElement *xmlScenarioList = xmlModel->FirstChildElement("ScenarioList");
+  if (xmlScenarioList == NULL) {
+    std::cout << "Error: Cannot find scenario list in file "
+              << run.scenariosFile << std::endl;
+    exit(1);
+  }
+  ScenariosList Scenarios;
+  Scenarios.createScenarios(xmlScenarioList, run.opDir);
+  if (run.drawsDir.length() > 0)
+    Scenarios.setDrawsOutput(run.drawsDir);
+
+  // burn-ins are identified by the parameters they were run with
+  std::unique_ptr<BurnInCache> burnInCache;
+  if (run.burnInDir.length() > 0) {
+    TiXmlPrinter printer;
+    xmlParameters->Accept(&printer);
+    burnInCache = std::make_unique<BurnInCache>(run.burnInDir, printer.Str());
+  }
+
+  // Run
+  Model model;
+  model.setEquilibriumBurnIn(run.equilibriumTolerance, run.minBurnInYears);
+  model.setForkScenarios(run.forkScenarios != 0);
+  model.setCommonRandomNumbers(run.commonRandomNumbers != 0);
+  model.setAntitheticPairs(run.antitheticPairs != 0);
+  model.setSequentialStopping(run.stoppingHalfWidth, run.stoppingYear);
+  model.setShowProgress(showProgress);
+  model.runScenarios(Scenarios, hostPopulation, vectors, worms, run.replicates,
+                     run.dt, run.index, run.outputEndgame,
+                     run.outputEndgameDate, run.outputNTDMC,
+                     run.outputNTDMCDate, run.reduceImpViaXml,
+                     run.randParamsfile, run.RandomSeedFile,
+                     run.CoverageReductionFile, run.opDir, run.threads,
+                     burnInCache.get());
+}
+
+static int runBatch(const RunOptions &batch, std::string idsFile) {
+
+  // one IU per line. Its files are the stems given with -s, -p and -g
+  // followed by the IU and .xml or .txt, as in run/run-lf-model.bash
+  std::ifstream idsIn(idsFile);
+  if (!idsIn.is_open()) {
+    std::cout << "Error: cannot read file " << idsFile << std::endl;
+    return 1;
+  }
+  std::vector<std::string> ids;
+  std::string id;
+  while (idsIn >> id)
+    ids.push_back(id);
+
+  // IUs are handed out one at a time to each thread as it becomes free, and
+  // each IU runs its replicates on that one thread. So at most threads IUs
+  // are held in memory at once, and a long IU doesn't hold up the others
+  int threads = std::max(1, std::min(batch.threads, (int)ids.size()));
+  TaskPool pool(threads);
+  std::mutex printMutex;
+  int iusDone = 0;
+
+  // queued last to first, so they are started in the order listed
+  for (int i = (int)ids.size() - 1; i >= 0; i--)
+    pool.add([&, i](int) {
+      RunOptions run = batch;
+      run.scenariosFile = batch.scenariosFile + ids[i] + ".xml";
+      run.randParamsfile = batch.randParamsfile + ids[i] + ".txt";
+      run.opDir = batch.opDir + ids[i] + "/";
+      run.threads = 1;
+      run.RandomSeedFile = "";
+      if (batch.RandomSeedFile.length() > 0) {
+        std::string seedFile = batch.RandomSeedFile + ids[i] + ".txt";
+        std::lock_guard<std::mutex> lock(printMutex);
+        if (fs::exists(seedFile))
+          run.RandomSeedFile = seedFile;
+        else
+          std::cout << "Warning: not using seed file " << seedFile
+                    << " as it doesn't exist" << std::endl;
+      }
+      fs::create_directories(run.opDir);
+
+      runModel(run, false);
+
+      std::lock_guard<std::mutex> lock(printMutex);
+      std::cout << std::endl
+                << "IU " << ids[i] << " done, " << ++iusDone << " of "
+                << ids.size() << std::endl;
+    });
+  pool.run();
+  return 0;
+}
+
 int main(int argc, char **argv) {
 
   if (argc < 2) {
@@ -51,7 +214,17 @@ int main(int argc, char **argv) {
         << "transfil index -s <scenarios_file> -n <pop_file> -p "
            "<random_parameters_file> -r <replicates=1000> -t <timestep=1> -o "
            "<output_directory=\"./\"> -g <random_seed=1> -e <output_endgame=1> "
-           "-x <reduce_imp_via-xml=0> -D <outputEndgameDate=2000>"
+           "-x <reduce_imp_via-xml=0> -D <outputEndgameDate=2000> "
+           "-j <threads=1> -w <draws_directory> -b <burn_in_cache_directory> "
+           "-E <burn_in_equilibrium_tolerance=0> -M <min_burn_in_years=30> "
+           "-F <fork_scenarios=0> -C <common_random_numbers=0> "
+           "-P <expected_prevalence=0> -a <antithetic_pairs=0> "
+           "-A <stopping_half_width=0> -Y <stopping_year=last>"
+        << std::endl
+        << "transfil batch --ids <running_id_file> -s <scenarios_file_stem> "
+           "-p <random_parameters_file_stem> -g <random_seed_file_stem> "
+           "-o <results_directory=\"./\"> -j <ius_at_once=1> and the other "
+           "options above"
         << std::endl;
     return 1;
   }
@@ -59,30 +232,40 @@ int main(int argc, char **argv) {
   struct timeval tv1, tv2;
   gettimeofday(&tv1, NULL);
 
-  int replicates = 0;
-  double dt = 1.0;
-  std::string popFile;
-  std::string randParamsfile("");
-  std::string scenariosFile("");
-  std::string opDir("");
-  std::string RandomSeedFile("");
-  std::string CoverageReductionFile("");
+  RunOptions run;
+  run.index = 0;
+  run.replicates = 0;
+  run.dt = 1.0;
+  run.equilibriumTolerance = 0.0;
+  run.minBurnInYears = 30;
 
   // initialize random seed value, whether the endgame output will be done
   // and whether the reduction in importation rate should be done via the
   // xml file rather than impact of MDA on the prevalence
-  int outputEndgame = 1;
-  int outputEndgameDate = 2000;
-  bool outputNTDMC = true;
-  int outputNTDMCDate = 2000;
-  int reduceImpViaXml = 0;
+  run.outputEndgame = 1;
+  run.outputEndgameDate = 2000;
+  run.outputNTDMC = true;
+  run.outputNTDMCDate = 2000;
+  run.reduceImpViaXml = 0;
   int NTDMC = 1;
-  int index = 0;
+  run.threads = 1;
+  run.forkScenarios = 0;
+  run.commonRandomNumbers = 0;
+  run.expectedPrevalence = 0;
+  run.antitheticPairs = 0;
+  run.stoppingHalfWidth = 0.0;
+  run.stoppingYear = 0;
+
+  // in batch mode -s, -p and -g give the start of each IU's file names and
+  // -o the folder below which each IU's results go
+  bool batch = !strcmp(argv[1], "batch");
+  std::string idsFile("");
+
   if (!strcmp(argv[1], "DEBUG")) {
     _DEBUG = true;
-    replicates = 1;
-  } else
-    index = atoi(argv[1]); // used for labelling output files
+    run.replicates = 1;
+  } else if (!batch)
+    run.index = atoi(argv[1]); // used for labelling output files
 
   int start_index = 2;
   if ((argc % 2) == 0) {
@@ -95,31 +278,55 @@ int main(int argc, char **argv) {
 
     if (!strcmp(argv[i], "-r")) {
       if (!_DEBUG)
-        replicates = atoi(argv[i + 1]);
+        run.replicates = atoi(argv[i + 1]);
     } else if (!strcmp(argv[i], "-s"))
-      scenariosFile = argv[i + 1];
+      run.scenariosFile = argv[i + 1];
     else if (!strcmp(argv[i], "-n"))
-      popFile = argv[i + 1];
+      run.popFile = argv[i + 1];
     else if (!strcmp(argv[i], "-p"))
-      randParamsfile = argv[i + 1];
+      run.randParamsfile = argv[i + 1];
     else if (!strcmp(argv[i], "-t"))
-      dt = atof(argv[i + 1]);
+      run.dt = atof(argv[i + 1]);
     else if (!strcmp(argv[i], "-o"))
-      opDir = argv[i + 1];
+      run.opDir = argv[i + 1];
     else if (!strcmp(argv[i], "-g"))
-      RandomSeedFile = argv[i + 1];
+      run.RandomSeedFile = argv[i + 1];
     else if (!strcmp(argv[i], "-c"))
-      CoverageReductionFile = argv[i + 1];
+      run.CoverageReductionFile = argv[i + 1];
     else if (!strcmp(argv[i], "-e"))
-      outputEndgame = atoi(argv[i + 1]);
+      run.outputEndgame = atoi(argv[i + 1]);
     else if (!strcmp(argv[i], "-D"))
-      outputEndgameDate = atoi(argv[i + 1]);
+      run.outputEndgameDate = atoi(argv[i + 1]);
     else if (!strcmp(argv[i], "-m"))
       NTDMC = atoi(argv[i + 1]);
     else if (!strcmp(argv[i], "-N"))
-      outputNTDMCDate = atoi(argv[i + 1]);
+      run.outputNTDMCDate = atoi(argv[i + 1]);
     else if (!strcmp(argv[i], "-x"))
-      reduceImpViaXml = atoi(argv[i + 1]);
+      run.reduceImpViaXml = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "-j"))
+      run.threads = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "-w"))
+      run.drawsDir = argv[i + 1];
+    else if (!strcmp(argv[i], "-b"))
+      run.burnInDir = argv[i + 1];
+    else if (!strcmp(argv[i], "-E"))
+      run.equilibriumTolerance = atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "-M"))
+      run.minBurnInYears = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "-F"))
+      run.forkScenarios = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "-C"))
+      run.commonRandomNumbers = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "-P"))
+      run.expectedPrevalence = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "-a"))
+      run.antitheticPairs = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "-A"))
+      run.stoppingHalfWidth = atof(argv[i + 1]);
+    else if (!strcmp(argv[i], "-Y"))
+      run.stoppingYear = atoi(argv[i + 1]);
+    else if (batch && !strcmp(argv[i], "--ids"))
+      idsFile = argv[i + 1];
     else {
       std::cout << "Error: unknown command line switch " << argv[i]
                 << std::endl;
@@ -129,84 +336,69 @@ int main(int argc, char **argv) {
   // input "-m 0" when running from command line if we don't want to
   // output NTDMC data.
   if (NTDMC == 0) {
-    outputNTDMC = false;
+    run.outputNTDMC = false;
   }
-  std::cout << "outputNTDMC = " << outputNTDMC << std::endl;
+  std::cout << "outputNTDMC = " << run.outputNTDMC << std::endl;
   for (int i = 0; i < argc; i++)
     std::cout << argv[i] << " ";
   std::cout << std::endl << std::endl;
 
   // validate
 
-  if (scenariosFile.length() == 0) {
+  if (batch && idsFile.length() == 0) {
+    std::cout << "Error: Running ID file undefined." << std::endl;
+    return 1;
+  }
+  if (run.scenariosFile.length() == 0) {
     std::cout << "Error: Scenarios file undefined." << std::endl;
     return 1;
   }
 
-  if (popFile.length() == 0) {
+  if (run.popFile.length() == 0) {
     std::cout << "Error: Population size file undefined." << std::endl;
     return 1;
   }
-  if (!replicates) {
-    replicates = 1000;
-    std::cout << "Replicates undefined so using default value of " << replicates
-              << std::endl;
+  if (!run.replicates) {
+    run.replicates = 1000;
+    std::cout << "Replicates undefined so using default value of "
+              << run.replicates << std::endl;
   }
-  if (randParamsfile.length() == 0) {
+  if (run.randParamsfile.length() == 0) {
     std::cout << "Error: Random parameters file undefined." << std::endl;
     return 1;
   }
-  std::cout << std::endl;
-
-  if (opDir.length() == 0)
-    opDir = "./";
-  else if (opDir.back() != '/')
-    opDir = opDir + "/";
-
-  // Read the inputs
-
-  TiXmlDocument scenariosDoc(scenariosFile);
-  if (!scenariosDoc.LoadFile()) {
-    std::cout << "Error: cannot read file " << scenariosFile << std::endl;
-    exit(1);
-  }
-  TiXmlElement *xmlModel = scenariosDoc.RootElement(); //<Model> element
-  if (xmlModel == NULL) {
-    std::cout << "Error: Invalid file " << scenariosFile
-              << ". Does not contain the <Model> root element" << std::endl;
-    exit(1);
+  if (run.equilibriumTolerance < 0 || run.minBurnInYears < 0) {
+    std::cout << "Error: Burn-in tolerance and minimum years must not be "
+                 "negative."
+              << std::endl;
+    return 1;
   }
-
-  TiXmlElement *xmlParameters = xmlModel->FirstChildElement("ParamList");
-  if (xmlParameters == NULL) {
-    std::cout << "Error: Cannot find parameter values in file " << scenariosFile
+  if (run.antitheticPairs && run.replicates % 2) {
+    std::cout << "Error: Antithetic pairs need an even number of replicates."
               << std::endl;
-    exit(1);
+    return 1;
   }
-
-  // Create the Vector, Worm and Host population objects
-  Vector vectors(xmlParameters);
-  Worm worms(xmlParameters);
-  Population hostPopulation(xmlParameters);
-
-  hostPopulation.loadPopulationSize(popFile);
-
-  // Create Scenarios
-  TiXmlElement *xmlScenarioList = xmlModel->FirstChildElement("ScenarioList");
-  if (xmlScenarioList == NULL) {
-    std::cout << "Error: Cannot find scenario list in file " << scenariosFile
+  if (run.stoppingHalfWidth < 0) {
+    std::cout << "Error: Stopping half-width must not be negative."
               << std::endl;
-    exit(1);
+    return 1;
   }
-  ScenariosList Scenarios;
-  Scenarios.createScenarios(xmlScenarioList, opDir);
+  if (run.threads < 1) {
+    std::cout << "Error: Number of threads must be at least 1." << std::endl;
+    return 1;
+  }
+  std::cout << std::endl;
 
-  // Run
-  Model model;
-  model.runScenarios(Scenarios, hostPopulation, vectors, worms, replicates, dt,
-                     index, outputEndgame, outputEndgameDate, outputNTDMC,
-                     outputNTDMCDate, reduceImpViaXml, randParamsfile,
-                     RandomSeedFile, CoverageReductionFile, opDir);
+  if (run.opDir.length() == 0)
+    run.opDir = "./";
+  else if (run.opDir.back() != '/')
+    run.opDir = run.opDir + "/";
+
+  if (batch) {
+    if (runBatch(run, idsFile))
+      return 1;
+  } else
+    runModel(run, true);
 
   gettimeofday(&tv2, NULL);
   double timesofar = (double)(tv2.tv_usec - tv1.tv_usec) / 1000000.0 +
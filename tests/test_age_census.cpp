@@ -0,0 +1,64 @@
+#include "AgeCensus.hpp"
+#include "HostStore.hpp"
+#include "MFPositive.hpp"
+#include "Statistics.hpp"
+#include <catch2/catch_all.hpp>
+#include <cmath>
+
+TEST_CASE("AgeCensus", "[classic]") {
+  SECTION("AgeCensus::take bins hosts by year of age") {
+
+    // ages in months. 12 and 1200 are on a whole year
+    double ages[] = {0.0, 12.0, 18.0, 30.0, 1200.0};
+    int size = 5;
+    int maxAge = 100;
+    HostStore hosts(size);
+    for (int i = 0; i < size; i++) {
+      hosts.age[i] = ages[i];
+      hosts.sex[i] = (i == 3) ? 1 : 0;
+      hosts.hydroMult[i] = 1.0;
+      hosts.lymphoMult[i] = 1.0;
+      hosts.totalWorms[i] = (i == 2) ? 0 : 10;
+    }
+    Statistics stats;
+    stats.set_seed(1);
+
+    AgeCensus census;
+    MFPositive mfPositive;
+    census.take(hosts, size, maxAge, 5, 5, stats, mfPositive);
+
+    // counts are of hosts aged [j, j+1) years
+    REQUIRE(census.number[0] == 1);
+    REQUIRE(census.number[1] == 2);
+    REQUIRE(census.number[2] == 1);
+    REQUIRE(census.number[99] == 0);
+
+    // sequelae count hosts aged [j, j+1] years, hydrocele only in men
+    REQUIRE(census.hydrocele[0] == 1.0);
+    REQUIRE(census.hydrocele[1] == 0.5);
+    REQUIRE(census.hydrocele[2] == 0.0);
+    REQUIRE(census.lymphodema[2] == 1.0);
+    REQUIRE(census.hydrocele[99] == 1.0);
+
+    // no mf anywhere
+    REQUIRE(census.mfPrev[1] == 0.0);
+    REQUIRE(census.incidence[1] == 0);
+  }
+
+  SECTION("AgeCensus::take can give the expected mf prevalence") {
+
+    // two hosts in their first year, with and without mf
+    HostStore hosts(2);
+    hosts.age[0] = hosts.age[1] = 6.0;
+    hosts.M[0] = 2.0;
+    Statistics stats;
+    stats.set_seed(1);
+
+    AgeCensus census;
+    MFPositive mfPositive;
+    census.take(hosts, 2, 100, 5, 5, stats, mfPositive, true);
+
+    REQUIRE_THAT(census.mfPrev[0],
+                 Catch::Matchers::WithinRel((1 - exp(-2.0)) / 2, 1e-12));
+  }
+}
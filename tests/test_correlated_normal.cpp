@@ -0,0 +1,48 @@
+#include "CorrelatedNormal.hpp"
+#include "Statistics.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("CorrelatedNormal", "[classic]") {
+  SECTION("CorrelatedNormal::draw matches factoring for every draw") {
+
+    double sigmaMDA = 0.8, sigmaBednets = 1.3, rhoBU = 0.2, rhoCN = -0.4;
+    const double covariance[3][3] = {
+        {1.0, sigmaMDA * rhoBU, sigmaMDA * rhoCN * sigmaBednets},
+        {sigmaMDA * rhoBU, sigmaMDA * sigmaMDA, 0.0},
+        {sigmaMDA * rhoCN * sigmaBednets, 0.0, sigmaBednets * sigmaBednets}};
+    const double mean[3] = {0.0, -0.5, 1.5};
+
+    CorrelatedNormal compliance(covariance);
+    Statistics stats, statsGsl;
+    stats.set_seed(7);
+    statsGsl.set_seed(7);
+
+    for (int draw = 0; draw < 20; draw++) {
+
+      double result[3];
+      compliance.draw(mean, stats, result);
+
+      // as rmvnorm did it
+      gsl_matrix *work = gsl_matrix_alloc(3, 3);
+      for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+          gsl_matrix_set(work, i, j, covariance[i][j]);
+      gsl_linalg_cholesky_decomp(work);
+      gsl_vector *expected = gsl_vector_alloc(3);
+      gsl_vector *meanGsl = gsl_vector_alloc(3);
+      for (int k = 0; k < 3; k++) {
+        gsl_vector_set(expected, k, statsGsl.unit_normal_dist());
+        gsl_vector_set(meanGsl, k, mean[k]);
+      }
+      gsl_blas_dtrmv(CblasLower, CblasNoTrans, CblasNonUnit, work, expected);
+      gsl_vector_add(expected, meanGsl);
+
+      for (int k = 0; k < 3; k++)
+        REQUIRE(result[k] == gsl_vector_get(expected, k));
+
+      gsl_matrix_free(work);
+      gsl_vector_free(expected);
+      gsl_vector_free(meanGsl);
+    }
+  }
+}
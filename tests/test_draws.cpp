@@ -0,0 +1,45 @@
+#include "Draws.hpp"
+#include <catch2/catch_all.hpp>
+#include <sstream>
+
+TEST_CASE("Draws", "[classic]") {
+  SECTION("pythonFloat prints as Python does") {
+    REQUIRE(pythonFloat(37) == "37.0");
+    REQUIRE(pythonFloat(0.2) == "0.2");
+    REQUIRE(pythonFloat(-0.125) == "-0.125");
+    REQUIRE(pythonFloat(0.0001) == "0.0001");
+    REQUIRE(pythonFloat(0.00001) == "1e-05");
+    REQUIRE(pythonFloat(1.0 / 3) == "0.3333333333333333");
+    REQUIRE(pythonFloat(1e16) == "1e+16");
+    REQUIRE(pythonFloat(123456789012345.6) == "123456789012345.6");
+  }
+
+  SECTION("writeDraws puts replicates side by side and parts one after another") {
+    ReplicateCsv ihme = {"espen_loc,year_id,age_start,age_end,measure,draw_0\n"
+                         "1_AAA00001,2000,0,1,prevalence,0.25\n"
+                         "1_AAA00001,2000,1,2,prevalence,0\n",
+                         "draw_0\n0.5\n1\n"};
+    ReplicateCsv survey = {
+        "espen_loc,year_id,age_start,age_end,measure,draw_0\n"
+        "1_AAA00001,None,None,None,surveyed,3\n",
+        "draw_0\n4\n"};
+
+    std::ostringstream out;
+    writeDraws(out, {&ihme, &survey});
+    // year and ages are floats, with the survey's missing values empty
+    REQUIRE(out.str() ==
+            "espen_loc,year_id,age_start,age_end,measure,draw_0,draw_1\n"
+            "1_AAA00001,2000.0,0.0,1.0,prevalence,0.25,0.5\n"
+            "1_AAA00001,2000.0,1.0,2.0,prevalence,0.0,1.0\n"
+            "1_AAA00001,,,,surveyed,3.0,4.0\n");
+
+    // a short replicate leaves missing values
+    ihme[1] = "draw_0\n7\n";
+    std::ostringstream shortOut;
+    writeDraws(shortOut, {&ihme});
+    REQUIRE(shortOut.str() ==
+            "espen_loc,year_id,age_start,age_end,measure,draw_0,draw_1\n"
+            "1_AAA00001,2000,0,1,prevalence,0.25,7.0\n"
+            "1_AAA00001,2000,1,2,prevalence,0.0,\n");
+  }
+}
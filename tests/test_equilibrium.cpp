@@ -0,0 +1,35 @@
+#include "Equilibrium.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("Equilibrium", "[classic]") {
+  SECTION("Equilibrium::reached") {
+
+    Equilibrium equilibrium(0.05, 2);
+
+    // needs two full windows of readings
+    equilibrium.addYear(1.0, 0.1, 10.0);
+    equilibrium.addYear(1.0, 0.1, 10.0);
+    equilibrium.addYear(1.0, 0.1, 10.0);
+    REQUIRE_FALSE(equilibrium.reached());
+    equilibrium.addYear(1.0, 0.1, 10.0);
+    REQUIRE(equilibrium.reached());
+
+    // worm burden still rising
+    equilibrium.addYear(1.0, 0.1, 12.0);
+    equilibrium.addYear(1.0, 0.1, 12.0);
+    REQUIRE_FALSE(equilibrium.reached());
+
+    // within tolerance of the window before
+    equilibrium.addYear(1.02, 0.1, 12.2);
+    equilibrium.addYear(0.99, 0.1, 12.1);
+    REQUIRE(equilibrium.reached());
+  }
+
+  SECTION("Infection that has died out is at equilibrium") {
+
+    Equilibrium equilibrium(0.01, 1);
+    equilibrium.addYear(0.0, 0.0, 0.0);
+    equilibrium.addYear(0.0, 0.0, 0.0);
+    REQUIRE(equilibrium.reached());
+  }
+}
@@ -1,5 +1,11 @@
 #include "Host.hpp"
+#include "HostSnapshot.hpp"
+#include "Statistics.hpp"
+#include "Vector.hpp"
+#include "Worm.hpp"
+#include "tinyxml.h"
 #include <catch2/catch_all.hpp>
+#include <cmath>
 
 TEST_CASE("Host", "[classic]") {
   SECTION("Host::restore") {
@@ -7,10 +13,11 @@ TEST_CASE("Host", "[classic]") {
     int size = 1;
     double TotalBiteRisk = 0.0;
     Host host_pop;
+    Statistics stats;
 
     // initialise population and set pTreat value
 
-    host_pop.initialise(1.0, 100, 0.2, &TotalBiteRisk, 0.1, 0.1, 0.0);
+    host_pop.initialise(1.0, 100, 0.2, &TotalBiteRisk, 0.1, 0.1, 0.0, stats);
     host_pop.WM = 1;
     host_pop.WF = 2;
     host_pop.totalWorms = 3;
@@ -64,4 +71,160 @@ TEST_CASE("Host", "[classic]") {
     REQUIRE(host_pop.sex == 0);
     REQUIRE(host_pop.pTreat == 3.1415926535);
   }
+
+  SECTION("Host view of a HostStore") {
+    // a Host constructed on a store reads and writes that store's columns
+    HostStore store(3);
+    Host host(store, 1);
+
+    host.WM = 4;
+    host.M = 2.5;
+    host.bedNet = 1;
+    store.age[1] = 12.0;
+
+    REQUIRE(store.WM[1] == 4);
+    REQUIRE(store.M[1] == 2.5);
+    REQUIRE(store.bedNet[1] == 1);
+    REQUIRE(host.age == 12.0);
+    REQUIRE(store.WM[0] == 0);
+    REQUIRE(store.WM[2] == 0);
+  }
+
+  SECTION("HostSnapshot shares unchanged chunks") {
+    int size = 1000;
+    HostStore store(size);
+    for (int i = 0; i < size; i++) {
+      store.age[i] = i;
+      store.WM[i] = i % 7;
+    }
+    HostSnapshot first(store, size, NULL);
+
+    // one host changes, so only its chunk of the age column is copied
+    store.age[600] = -1.0;
+    HostSnapshot second(store, size, &first);
+    REQUIRE(second.bytesOwned() == 256 * sizeof(double));
+
+    store.age[600] = 3.0;
+    store.WM[999] = 100;
+    second.restore(store);
+    REQUIRE(store.age[600] == -1.0);
+    REQUIRE(store.WM[999] == 999 % 7);
+    first.restore(store);
+    REQUIRE(store.age[600] == 600.0);
+  }
+
+  SECTION("Host::react death and importation") {
+    TiXmlDocument doc;
+    doc.Parse("<ParamList><vector>"
+              "<param name=\"species\" value=\"0\" />"
+              "<param name=\"L3\" value=\"5\" />"
+              "<param name=\"lambda\" value=\"10\" />"
+              "<param name=\"g\" value=\"0.37\" />"
+              "<param name=\"kappas1\" value=\"4.395\" />"
+              "<param name=\"r1\" value=\"0.055\" />"
+              "<param name=\"sigma\" value=\"5.0\" />"
+              "</vector><worm>"
+              "<param name=\"nu\" value=\"0.0\" />"
+              "<param name=\"alpha\" value=\"1.0\" />"
+              "<param name=\"psi1\" value=\"0.414\" />"
+              "<param name=\"psi2\" value=\"0.32\" />"
+              "<param name=\"s2\" value=\"0.00275\" />"
+              "<param name=\"mu\" value=\"0.0104\" />"
+              "<param name=\"gamma\" value=\"0.1\" />"
+              "</worm></ParamList>");
+    Vector vectors(doc.RootElement());
+    Worm worms(doc.RootElement());
+    vectors.reset("exp", 0.0);
+
+    // an adult with mf, so that an import shows as M reset to 0
+    auto adult = [](Host &host) {
+      host.age = 240;
+      host.WM = host.WF = host.totalWorms = 0;
+      host.M = 5.0;
+    };
+    double rate = 0.3;
+    double p = 1 - exp(-rate);
+    int deaths = 0, antitheticDeaths = 0, imports = 0, antitheticImports = 0;
+
+    for (unsigned long seed = 1; seed <= 1000; seed++) {
+      Statistics first, second, uniforms;
+      first.set_seed(seed);
+      first.setPairing(Statistics::firstOfPair);
+      second.set_seed(seed);
+      second.setPairing(Statistics::secondOfPair);
+      uniforms.set_seed(seed);
+      double u = uniforms.uniform_dist();
+
+      // death is the first draw, and the second of the pair dies when the
+      // first draws u > 1 - p. With p < 0.5 they never both die
+      Host a, b;
+      adult(a);
+      adult(b);
+      a.react(1.0, rate, 100, 0.0, vectors, worms, 1.0, 1.0, 0.0, first);
+      b.react(1.0, rate, 100, 0.0, vectors, worms, 1.0, 1.0, 0.0, second);
+      REQUIRE((a.age == 0) == (u < p));
+      REQUIRE((b.age == 0) == (1 - u < p));
+      REQUIRE_FALSE((a.age == 0 && b.age == 0));
+      deaths += a.age == 0;
+      antitheticDeaths += b.age == 0;
+
+      // importation is the second draw
+      first.set_seed(seed);
+      second.set_seed(seed);
+      uniforms.set_seed(seed);
+      uniforms.uniform_dist();
+      u = uniforms.uniform_dist();
+      adult(a);
+      adult(b);
+      a.react(1.0, 0.0, 100, rate, vectors, worms, 1.0, 1.0, 0.0, first);
+      b.react(1.0, 0.0, 100, rate, vectors, worms, 1.0, 1.0, 0.0, second);
+      REQUIRE((a.M == 0) == (u < p));
+      REQUIRE((b.M == 0) == (1 - u < p));
+      imports += a.M == 0;
+      antitheticImports += b.M == 0;
+    }
+
+    // both members of the pair see events at the same rate, about 259 in 1000
+    REQUIRE(deaths > 200);
+    REQUIRE(deaths < 320);
+    REQUIRE(antitheticDeaths > 200);
+    REQUIRE(antitheticDeaths < 320);
+    REQUIRE(imports > 200);
+    REQUIRE(imports < 320);
+    REQUIRE(antitheticImports > 200);
+    REQUIRE(antitheticImports < 320);
+
+    // with the population's clock, a host dies or is replaced by an import
+    // when the clock reaches its time, and the next time is drawn then
+    Statistics stats;
+    eventClock clock = {0.0, 0.0};
+    Host c;
+    adult(c);
+    c.deathAt = 2.0;
+    c.importAt = 5.0;
+    clock.deaths = 1.5;
+    c.react(1.0, rate, 100, rate, vectors, worms, 1.0, 1.0, 0.0, stats, &clock);
+    REQUIRE(c.age == 241);
+    REQUIRE(c.M > 0);
+    clock.imports = 5.0;
+    c.react(1.0, rate, 100, rate, vectors, worms, 1.0, 1.0, 0.0, stats, &clock);
+    REQUIRE(c.M == 0);
+    REQUIRE(c.importAt > 5.0);
+    clock.deaths = 2.0;
+    c.react(1.0, rate, 100, rate, vectors, worms, 1.0, 1.0, 0.0, stats, &clock);
+    REQUIRE(c.age == 0);
+    REQUIRE(c.deathAt > 2.0);
+
+    // and the chance of dying as the clock moves on by rate is p
+    HostStore store(1000);
+    clock = {0.0, 0.0};
+    for (int i = 0; i < 1000; i++)
+      Host(store, i).scheduleEvents(clock, stats);
+    clock.deaths += rate;
+    int scheduledDeaths = 0;
+    for (int i = 0; i < 1000; i++)
+      scheduledDeaths += store.deathAt[i] <= clock.deaths;
+    REQUIRE(scheduledDeaths > 200);
+    REQUIRE(scheduledDeaths < 320);
+  }
 }
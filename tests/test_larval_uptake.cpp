@@ -0,0 +1,39 @@
+#include "LarvalUptake.hpp"
+#include <catch2/catch_all.hpp>
+#include <random>
+#include <vector>
+
+TEST_CASE("LarvalUptake", "[classic]") {
+  SECTION("larvalUptake agrees with the scalar kernel") {
+
+    // a population whose size is not a multiple of the vector width, with mf
+    // from none to far more than saturates the exp
+    int n = 2003;
+    std::mt19937 gen(1);
+    std::gamma_distribution<double> risk(0.3, 1.0 / 0.3);
+    std::exponential_distribution<double> mf(0.05);
+    std::vector<double> M(n), biteRisk(n);
+    for (int i = 0; i < n; i++) {
+      M[i] = (i % 5 == 0) ? 0.0 : mf(gen);
+      biteRisk[i] = risk(gen);
+    }
+    M[1] = 1.0e5;
+
+    for (bool squared : {false, true}) {
+      double r1 = squared ? 0.0111 : 0.0104;
+      double kappas1 = squared ? 4.395 : 2.0;
+      double expected = larvalUptakeScalar(M.data(), biteRisk.data(), n, r1,
+                                           kappas1, squared);
+      double actual =
+          larvalUptake(M.data(), biteRisk.data(), n, r1, kappas1, squared);
+      REQUIRE(expected > 0.0);
+      REQUIRE_THAT(actual, Catch::Matchers::WithinRel(expected, 1e-12));
+
+      // fewer hosts than the vector width
+      expected =
+          larvalUptakeScalar(M.data(), biteRisk.data(), 3, r1, kappas1, squared);
+      actual = larvalUptake(M.data(), biteRisk.data(), 3, r1, kappas1, squared);
+      REQUIRE_THAT(actual, Catch::Matchers::WithinRel(expected, 1e-12));
+    }
+  }
+}
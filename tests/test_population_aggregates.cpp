@@ -0,0 +1,30 @@
+#include "HostStore.hpp"
+#include "PopulationAggregates.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("PopulationAggregates", "[classic]") {
+  SECTION("PopulationAggregates follows hosts as they change") {
+
+    HostStore hosts(4);
+    for (int i = 0; i < 4; i++) {
+      hosts.bedNet[i] = (i < 2) ? 1 : 0;
+      hosts.totalWorms[i] = 10 * i;
+    }
+
+    PopulationAggregates aggregates;
+    aggregates.recount(hosts);
+    REQUIRE(aggregates.bedNetCoverage() == 0.5);
+    REQUIRE(aggregates.meanWormBurden() == 15.0);
+
+    // host 1 dies and is reborn without a net or worms
+    aggregates.remove(hosts, 1);
+    hosts.bedNet[1] = 0;
+    hosts.totalWorms[1] = 0;
+    aggregates.add(hosts, 1);
+    REQUIRE(aggregates.bedNetCoverage() == 0.25);
+    REQUIRE(aggregates.meanWormBurden() == 12.5);
+
+    // agrees with a scan, else check would exit
+    aggregates.check(hosts, "test");
+  }
+}
@@ -0,0 +1,29 @@
+#include "RandomParameters.hpp"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("RandomParameters", "[classic]") {
+  SECTION("RandomParameters::parse") {
+
+    // v_to_h, k, aImp and wPropMDA for 2 years per line. The last line is
+    // not needed for 2 replicates
+    std::string text = "125.5318 0.931516 0.0000095992 -1 120 0.9 9.6e-06 -1\n"
+                       "47.4499\t0.784228 0.0000069508 +0.5  47 0.7 7e-06 0.5\r\n"
+                       "1 2 3\n";
+
+    RandomParameters params;
+    params.parse(text, 2, "test");
+    REQUIRE(params.getNumReplicates() == 2);
+    REQUIRE(params.getNumYears() == 2);
+
+    std::vector<double> k_vals, v_to_h_vals, aImp_vals, wProp_vals;
+    params.getReplicate(1, k_vals, v_to_h_vals, aImp_vals, wProp_vals);
+    REQUIRE(v_to_h_vals == std::vector<double>{47.4499, 47});
+    REQUIRE(k_vals == std::vector<double>{0.784228, 0.7});
+    REQUIRE(aImp_vals == std::vector<double>{0.0000069508, 7e-06});
+    REQUIRE(wProp_vals == std::vector<double>{0.5, 0.5});
+
+    params.getReplicate(0, k_vals, v_to_h_vals, aImp_vals, wProp_vals);
+    REQUIRE(v_to_h_vals == std::vector<double>{125.5318, 120});
+    REQUIRE(aImp_vals == std::vector<double>{0.0000095992, 9.6e-06});
+  }
+}
@@ -0,0 +1,59 @@
+#include "ReplicateStopping.hpp"
+#include <catch2/catch_all.hpp>
+#include <cmath>
+
+TEST_CASE("ReplicateStopping", "[classic]") {
+  SECTION("ReplicateStopping::mfPrevalence") {
+
+    ReplicateStopping stopping(0.1, 1);
+
+    // replicates may arrive out of order
+    stopping.add(0, 1, 0.3, false);
+    stopping.add(0, 0, 0.1, false);
+    stopping.add(0, 2, 0.2, true);
+
+    ReplicateStopping::estimate e = stopping.mfPrevalence(0, 3);
+    REQUIRE_THAT(e.mean, Catch::Matchers::WithinRel(0.2, 1e-12));
+    // sd 0.1
+    REQUIRE_THAT(e.halfWidth,
+                 Catch::Matchers::WithinRel(1.96 * 0.1 / std::sqrt(3.0), 1e-12));
+
+    // only the first replicates count
+    REQUIRE_THAT(stopping.mfPrevalence(0, 2).mean,
+                 Catch::Matchers::WithinRel(0.2, 1e-12));
+  }
+
+  SECTION("ReplicateStopping::precise") {
+
+    ReplicateStopping stopping(0.25, 2);
+    for (int rep = 0; rep < 20; rep++) {
+      stopping.add(0, rep, 0.05, false);
+      stopping.add(1, rep, 0.05 + 0.01 * (rep % 2), false);
+    }
+    // no replicate reached EPHP, but 20 is too few to be sure of that
+    REQUIRE(stopping.EPHP(0, 20).mean == 0.0);
+    REQUIRE(stopping.EPHP(0, 20).halfWidth > 0.1);
+    REQUIRE(stopping.precise(20));
+
+    ReplicateStopping tighter(0.1, 2);
+    for (int rep = 0; rep < 20; rep++) {
+      tighter.add(0, rep, 0.05, false);
+      tighter.add(1, rep, 0.05, false);
+    }
+    REQUIRE_FALSE(tighter.precise(20));
+  }
+
+  SECTION("ReplicateStopping with antithetic pairs") {
+
+    // the two of each pair are far apart but their average is steady
+    ReplicateStopping stopping(0.05, 1, true);
+    for (int rep = 0; rep < 20; rep++)
+      stopping.add(0, rep, rep % 2 ? 0.3 : 0.1, rep % 2);
+
+    REQUIRE_THAT(stopping.mfPrevalence(0, 20).mean,
+                 Catch::Matchers::WithinRel(0.2, 1e-12));
+    REQUIRE(stopping.mfPrevalence(0, 20).halfWidth < 1e-12);
+    REQUIRE_THAT(stopping.EPHP(0, 20).mean,
+                 Catch::Matchers::WithinRel(0.5, 1e-12));
+  }
+}
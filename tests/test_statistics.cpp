@@ -0,0 +1,75 @@
+#include "Statistics.hpp"
+#include <catch2/catch_all.hpp>
+#include <vector>
+
+TEST_CASE("Statistics", "[classic]") {
+  SECTION("Statistics::getState and setState") {
+
+    Statistics stats;
+    stats.set_seed(42);
+    stats.uniform_dist();
+
+    // save the stream part way through, then draw some numbers
+    std::vector<char> saved = stats.getState();
+    std::vector<double> draws;
+    for (int i = 0; i < 10; i++)
+      draws.push_back(stats.uniform_dist());
+
+    // restoring the state should give the same numbers again
+    stats.setState(saved);
+    for (int i = 0; i < 10; i++)
+      REQUIRE(stats.uniform_dist() == draws[i]);
+  }
+
+  SECTION("Statistics copies continue the same stream independently") {
+
+    Statistics stats;
+    stats.set_seed(7);
+    Statistics copy(stats);
+
+    double a = stats.uniform_dist();
+    double b = stats.uniform_dist();
+
+    REQUIRE(copy.uniform_dist() == a);
+
+    // assigning catches the copy up with the original
+    copy = stats;
+    double c = stats.uniform_dist();
+    REQUIRE(copy.uniform_dist() == c);
+    REQUIRE(b != c);
+  }
+
+  SECTION("Statistics pairs stay in step") {
+
+    Statistics first, second;
+    first.set_seed(11);
+    first.setPairing(Statistics::firstOfPair);
+    second.set_seed(11);
+    second.setPairing(Statistics::secondOfPair);
+
+    // every sampler takes one uniform, so after any mix of draws the two
+    // streams are still at the same point
+    for (int i = 0; i < 100; i++) {
+      first.poisson_dist(0.1 * i);
+      second.poisson_dist(0.1 * i);
+      first.gamma_dist(0.5);
+      second.gamma_dist(0.5);
+      first.normal_dist(0.0, 1.0);
+      second.normal_dist(0.0, 1.0);
+      first.beta_dist(2.0, 3.0);
+      second.beta_dist(2.0, 3.0);
+      REQUIRE(first.uniform_int(10) + second.uniform_int(10) == 9);
+      REQUIRE_THAT(first.uniform_dist() + second.uniform_dist(),
+                   Catch::Matchers::WithinRel(1.0, 1e-12));
+    }
+
+    // the Poisson draws of a pair lie on opposite sides of the median
+    int below = 0;
+    for (int i = 0; i < 1000; i++) {
+      int a = first.poisson_dist(3.0);
+      int b = second.poisson_dist(3.0);
+      below += a <= 2 && b <= 2;
+    }
+    REQUIRE(below == 0);
+  }
+}
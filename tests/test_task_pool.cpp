@@ -0,0 +1,38 @@
+#include "TaskPool.hpp"
+#include <atomic>
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("TaskPool", "[classic]") {
+  SECTION("Tasks added by running tasks are run") {
+
+    TaskPool pool(3);
+    std::atomic<int> done(0);
+    std::atomic<int> badWorker(0);
+
+    // each root task forks two children, each of which forks two more
+    std::function<void(int)> branch = [&](int depth) {
+      pool.add([&, depth](int worker) {
+        if (worker < 0 || worker >= 3)
+          badWorker++;
+        if (depth < 2) {
+          branch(depth + 1);
+          branch(depth + 1);
+        }
+        done++;
+      });
+    };
+    for (int i = 0; i < 5; i++)
+      branch(0);
+    pool.run();
+
+    REQUIRE(done == 5 * 7);
+    REQUIRE(badWorker == 0);
+  }
+
+  SECTION("A pool with no tasks returns") {
+
+    TaskPool pool(2);
+    pool.run();
+    SUCCEED();
+  }
+}